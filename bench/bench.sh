@@ -0,0 +1,213 @@
+#!/bin/bash
+# Benchmark suite: runs the solver on a list of instances, records one CSV row per run and compares the result with a
+# stored baseline. Usually started with `make bench` from src/ (pass options in BENCH_ARGS).
+#
+# The solver makes no random choices, so repeated trials differ only through timing and thread scheduling; the
+# comparison uses the median of the trials of each instance.
+#
+# CSV columns: instance, trial, threads, status (optimal / timeout / wrong / error), colors (best coloring found),
+# lower_bound (proven), expected, time_ms (as reported by the solver), wall_ms (of the process), nodes, nodes_per_s,
+# peak_rss_mb, valid (coloring verified by the solver)
+
+usage() {
+    cat <<EOF
+Usage: $0 [options]
+  -b binary     solver to run (default: src/chromatic)
+  -l list       instance list, see bench/instances.txt (default)
+  -r trials     runs per instance (default 3)
+  -t seconds    solver -timeout of each run (default 60)
+  -j threads    OMP_NUM_THREADS (default: as set in the environment, else 1)
+  -a "args"     further solver arguments, e.g. "-engine portfolio"
+  -o file       results CSV (default: bench/results/<date>-<commit>.csv)
+  -c file       baseline CSV to compare with (default: bench/baseline.csv, skipped if missing)
+  -x percent    slowdown of the median time that counts as a regression (default 10)
+  -m ms         times below this are not compared, they are mostly noise (default 50)
+  -w            store the results as the new baseline instead of comparing
+  -T            also keep the bounds trace (-trace) of every run, next to the results CSV in <results>.traces/
+EOF
+    exit 1
+}
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+ROOT_DIR=$(dirname "$BENCH_DIR")
+BINARY=$ROOT_DIR/src/chromatic
+LIST=$BENCH_DIR/instances.txt
+TRIALS=3
+TIMEOUT=60
+THREADS=${OMP_NUM_THREADS:-1}
+SOLVER_ARGS=""
+OUTPUT=""
+BASELINE=$BENCH_DIR/baseline.csv
+TOLERANCE=10
+MIN_MS=50
+WRITE_BASELINE=0
+TRACE=0
+
+while getopts "b:l:r:t:j:a:o:c:x:m:wTh" opt; do
+    case $opt in
+        b) BINARY=$OPTARG ;;
+        l) LIST=$OPTARG ;;
+        r) TRIALS=$OPTARG ;;
+        t) TIMEOUT=$OPTARG ;;
+        j) THREADS=$OPTARG ;;
+        a) SOLVER_ARGS=$OPTARG ;;
+        o) OUTPUT=$OPTARG ;;
+        c) BASELINE=$OPTARG ;;
+        x) TOLERANCE=$OPTARG ;;
+        m) MIN_MS=$OPTARG ;;
+        w) WRITE_BASELINE=1 ;;
+        T) TRACE=1 ;;
+        *) usage ;;
+    esac
+done
+
+if [ ! -x "$BINARY" ]; then
+    echo "Solver $BINARY not found, build it first (make -C src)"
+    exit 1
+fi
+COMMIT=$(git -C "$ROOT_DIR" rev-parse --short HEAD 2>/dev/null || echo unknown)
+if [ -z "$OUTPUT" ]; then
+    mkdir -p "$BENCH_DIR/results"
+    OUTPUT=$BENCH_DIR/results/$(date +%Y%m%d-%H%M%S)-$COMMIT.csv
+fi
+
+TRACE_DIR=${OUTPUT%.csv}.traces
+[ "$TRACE" = 1 ] && mkdir -p "$TRACE_DIR"
+
+export OMP_NUM_THREADS=$THREADS
+export OMP_PROC_BIND=${OMP_PROC_BIND:-close}
+
+# value after "<label>: " in the results part of the solver output, the first number only
+field() { echo "$1" | sed -n '/^Results:/,$p' | grep -m1 "^$2:" | sed -e "s/^$2: *//" -e 's/[^0-9].*//'; }
+
+{
+    echo "# commit $COMMIT, $(hostname), $(date '+%Y-%m-%d %H:%M:%S'), binary $BINARY, args: -timeout $TIMEOUT $SOLVER_ARGS"
+    echo "instance,trial,threads,status,colors,lower_bound,expected,time_ms,wall_ms,nodes,nodes_per_s,peak_rss_mb,valid"
+} > "$OUTPUT"
+
+grep -v '^[[:space:]]*\(#\|$\)' "$LIST" | while read -r instance expected _; do
+    expected=${expected:--}
+    for trial in $(seq 1 "$TRIALS"); do
+        trace=""
+        [ "$TRACE" = 1 ] && trace="-trace $TRACE_DIR/$(basename "$instance" .col)-$trial.csv"
+        start=$(date +%s%N)
+        # the solver stops itself at -timeout; the outer limit only catches a hung process
+        out=$(cd "$ROOT_DIR" && timeout $((TIMEOUT + 30)) "$BINARY" -input "$instance" -timeout "$TIMEOUT" $SOLVER_ARGS $trace 2>&1)
+        wall=$(( ($(date +%s%N) - start) / 1000000 ))
+
+        colors=$(field "$out" "Chromatic number")
+        if [ -n "$colors" ]; then
+            status=optimal
+            lower=$colors
+        else
+            colors=$(field "$out" "Best coloring found")
+            lower=$(field "$out" "Lower bound")
+            status=$([ -n "$colors" ] && echo timeout || echo error)
+        fi
+        time=$(field "$out" "Computation time")
+        nodes=$(field "$out" "Nodes explored")
+        rss=$(field "$out" "Peak memory")
+        valid=$(echo "$out" | grep -q "^Solution verification: VALID" && echo 1 || echo 0)
+        if [ "$status" != error ] && [ "$expected" != - ]; then
+            if [ "$valid" = 0 ] || [ "$colors" -lt "$expected" ] || [ "$lower" -gt "$expected" ] \
+                || { [ "$status" = optimal ] && [ "$colors" != "$expected" ]; }; then
+                status=wrong
+            fi
+        fi
+        rate=""
+        if [ -n "$nodes" ] && [ -n "$time" ]; then
+            rate=$(( nodes * 1000 / (time > 0 ? time : 1) ))
+        fi
+
+        echo "$instance,$trial,$THREADS,$status,$colors,$lower,$expected,$time,$wall,$nodes,$rate,$rss,$valid" >> "$OUTPUT"
+        printf "%-36s trial %s  %-8s colors %-4s lb %-4s %8s ms %12s nodes %10s nodes/s %5s MB\n" \
+            "$instance" "$trial" "$status" "$colors" "$lower" "$time" "$nodes" "$rate" "$rss"
+    done
+done
+echo "Results written to $OUTPUT"
+
+if [ "$WRITE_BASELINE" = 1 ]; then
+    cp "$OUTPUT" "$BASELINE"
+    echo "Stored as the baseline $BASELINE"
+    exit 0
+fi
+if [ ! -f "$BASELINE" ]; then
+    echo "No baseline $BASELINE to compare with (store one with -w)"
+    exit 0
+fi
+
+# per instance: the status (optimal only if every trial was, else the last other one), and the median of each of
+# colors, lower bound, time and nodes/s over the trials, taken column by column; "-" where no trial has a value
+summarize() {
+    grep -v '^#' "$1" | tail -n +2 | sort -s -t, -k1,1 | awk -F, '
+        function add(column, value) {
+            if (value == "") return
+            count[column]++
+            values[column, count[column]] = value + 0
+        }
+        function median(column,    k, i, j, x) {
+            k = count[column]
+            if (k == 0) return "-"
+            for (i = 2; i <= k; i++) {
+                x = values[column, i]
+                for (j = i - 1; j >= 1 && values[column, j] > x; j--) values[column, j + 1] = values[column, j]
+                values[column, j + 1] = x
+            }
+            return values[column, int((k + 1) / 2)]
+        }
+        function flush() {
+            if (name == "") return
+            print name, status, median(5), median(6), median(8), median(11)
+        }
+        $1 != name { flush(); name = $1; status = $4; delete count }
+        { if ($4 != "optimal") status = $4; add(5, $5); add(6, $6); add(8, $8); add(11, $11) }
+        END { flush() }'
+}
+
+echo
+echo "Comparison with $BASELINE (median of the trials; regression: worse bounds, or more than $TOLERANCE% slower;"
+echo "runs that are not solved in both stop at the time limit, so for them the nodes/s are compared instead of the time)"
+printf "%-36s %10s %10s %8s %12s %12s  %s\n" instance "base ms" "now ms" ratio "base n/s" "now n/s" verdict
+regressions=0
+while read -r name status colors lower time rate; do
+    base=$(summarize "$BASELINE" | awk -v n="$name" '$1 == n')
+    if [ -z "$base" ]; then
+        printf "%-36s %10s %10s %8s %12s %12s  %s\n" "$name" - "$time" - - "$rate" "new instance"
+        continue
+    fi
+    read -r _ bstatus bcolors blower btime brate <<< "$base"
+    verdict=ok
+    ratio=$(awk -v a="$time" -v b="$btime" 'BEGIN { if (a != "-" && b > 0) printf "%.2f", a / b; else print "-" }')
+    if [ "$status" = wrong ] || [ "$status" = error ]; then
+        verdict="REGRESSION: $status"
+    elif [ "$bstatus" = optimal ] && [ "$status" != optimal ]; then
+        verdict="REGRESSION: no longer solved"
+    elif awk -v c="$colors" -v l="$lower" -v bc="$bcolors" -v bl="$blower" \
+            'BEGIN { exit !((c != "-" && bc != "-" && c + 0 > bc + 0) || (l != "-" && bl != "-" && l + 0 < bl + 0)) }'; then
+        verdict="REGRESSION: bounds $lower..$colors, were $blower..$bcolors"
+    elif [ "$status" = optimal ] && [ "$bstatus" != optimal ]; then
+        verdict="improved: now solved"
+    elif [ "$status" != optimal ]; then
+        if [ "$rate" != - ] && [ "$brate" != - ]; then
+            if awk -v a="$rate" -v b="$brate" -v t="$TOLERANCE" 'BEGIN { exit !(a * (1 + t / 100) < b) }'; then
+                verdict="REGRESSION: fewer nodes/s"
+            elif awk -v a="$rate" -v b="$brate" -v t="$TOLERANCE" 'BEGIN { exit !(a > b * (1 + t / 100)) }'; then
+                verdict="faster"
+            fi
+        fi
+    elif awk -v a="$time" -v b="$btime" -v m="$MIN_MS" 'BEGIN { exit !(a != "-" && b != "-" && (a >= m || b >= m)) }'; then
+        if awk -v a="$time" -v b="$btime" -v t="$TOLERANCE" 'BEGIN { exit !(a > b * (1 + t / 100)) }'; then
+            verdict="REGRESSION: slower"
+        elif awk -v a="$time" -v b="$btime" -v t="$TOLERANCE" 'BEGIN { exit !(a * (1 + t / 100) < b) }'; then
+            verdict="faster"
+        fi
+    fi
+    case $verdict in REGRESSION*) regressions=$((regressions + 1)) ;; esac
+    printf "%-36s %10s %10s %8s %12s %12s  %s\n" "$name" "$btime" "$time" "$ratio" "$brate" "$rate" "$verdict"
+done < <(summarize "$OUTPUT")
+
+if [ "$regressions" -gt 0 ]; then
+    echo "$regressions regression(s)"
+    exit 2
+fi
+echo "No regressions"
@@ -0,0 +1,182 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "BitSetKernels.h"
+
+/**
+ * @brief A dynamically sized set of bits, stored in 64-bit words.
+ *
+ * Used as the row type of the adjacency matrix. Unlike std::vector<bool>, the words are accessible directly,
+ * so that whole-row operations (AND, OR, popcount, iteration over set bits) run a word or a vector register at a
+ * time; see BitSetKernels.h.
+ * Invariant: bits past size() in the last word are always zero.
+ */
+class BitSet {
+public:
+    typedef uint64_t Word;
+    static const unsigned int bitsPerWord = 64;
+
+    /**
+     * @brief Proxy returned by the non-const operator[], so that bits can be assigned to as with std::vector<bool>
+     */
+    class reference {
+        Word* word;
+        Word mask;
+    public:
+        reference(Word* w, Word m) : word(w), mask(m) {}
+        operator bool() const { return (*word & mask) != 0; }
+        reference& operator= (bool value) {
+            if (value) *word |= mask; else *word &= ~mask;
+            return *this;
+        }
+        reference& operator= (const reference& other) { return *this = (bool)other; }
+    };
+
+    BitSet() : numBits(0) {}
+    explicit BitSet(size_t n, bool value = false) : numBits(0) { resize(n, value); }
+
+    static size_t wordsFor(size_t n) { return (n + bitsPerWord - 1) / bitsPerWord; }
+
+    size_t size() const { return numBits; }
+    size_t numWords() const { return words.size(); }
+    Word* data() { return words.data(); }
+    const Word* data() const { return words.data(); }
+
+    /**
+     * @brief Resize the set to #n bits; newly added bits are set to #value
+     */
+    void resize(size_t n, bool value = false) {
+        size_t oldBits = numBits;
+        words.resize(wordsFor(n), value ? ~(Word)0 : 0);
+        numBits = n;
+        if (value && n > oldBits && oldBits % bitsPerWord != 0)
+            words[oldBits / bitsPerWord] |= ~(Word)0 << (oldBits % bitsPerWord);
+        clearTail();
+    }
+
+    void clear() {
+        words.clear();
+        numBits = 0;
+    }
+
+    bool operator[] (size_t i) const { return (words[i / bitsPerWord] >> (i % bitsPerWord)) & 1; }
+    reference operator[] (size_t i) { return reference(&words[i / bitsPerWord], (Word)1 << (i % bitsPerWord)); }
+
+    bool test(size_t i) const { return (*this)[i]; }
+    void set(size_t i) { words[i / bitsPerWord] |= (Word)1 << (i % bitsPerWord); }
+    void reset(size_t i) { words[i / bitsPerWord] &= ~((Word)1 << (i % bitsPerWord)); }
+
+    void setAll() {
+        std::fill(words.begin(), words.end(), ~(Word)0);
+        clearTail();
+    }
+
+    void resetAll() { std::fill(words.begin(), words.end(), 0); }
+
+    void flip() {
+        for (size_t w = 0; w < words.size(); ++w) words[w] = ~words[w];
+        clearTail();
+    }
+
+    /**
+     * @brief Number of set bits
+     */
+    size_t count() const { return BitSetKernels::popcount(words.data(), words.size()); }
+
+    bool any() const {
+        for (size_t w = 0; w < words.size(); ++w)
+            if (words[w]) return true;
+        return false;
+    }
+
+    bool none() const { return !any(); }
+
+    /**
+     * @brief Index of the first set bit at position #from or later, -1 if there is none
+     */
+    long findNext(size_t from) const {
+        size_t w = from / bitsPerWord;
+        if (w >= words.size()) return -1;
+        Word bits = words[w] & (~(Word)0 << (from % bitsPerWord));
+        while (true) {
+            if (bits) return w * bitsPerWord + __builtin_ctzll(bits);
+            if (++w >= words.size()) return -1;
+            bits = words[w];
+        }
+    }
+
+    long findFirst() const { return findNext(0); }
+
+    /**
+     * @brief Call #f(i) for every set bit i, in increasing order
+     */
+    template<class F>
+    void forEach(F f) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            Word bits = words[w];
+            while (bits) {
+                f(w * bitsPerWord + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    BitSet& operator&= (const BitSet& other) {
+        BitSetKernels::andInto(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+
+    BitSet& operator|= (const BitSet& other) {
+        BitSetKernels::orInto(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+
+    /**
+     * @brief Remove all bits that are set in #other (this = this AND NOT other)
+     */
+    BitSet& andNot(const BitSet& other) {
+        BitSetKernels::andNotInto(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+
+    /**
+     * @brief Returns true if this set and #other have at least one common bit
+     */
+    bool intersects(const BitSet& other) const {
+        return BitSetKernels::intersects(words.data(), other.words.data(), words.size());
+    }
+
+    /**
+     * @brief Size of the intersection of this set and #other
+     */
+    size_t intersectionCount(const BitSet& other) const {
+        return BitSetKernels::intersectionCount(words.data(), other.words.data(), words.size());
+    }
+
+    /**
+     * @brief Returns true if every bit of this set is also set in #other
+     */
+    bool isSubsetOf(const BitSet& other) const {
+        for (size_t w = 0; w < words.size(); ++w)
+            if (words[w] & ~other.words[w]) return false;
+        return true;
+    }
+
+    bool operator== (const BitSet& other) const { return numBits == other.numBits && words == other.words; }
+    bool operator!= (const BitSet& other) const { return !(*this == other); }
+
+private:
+    std::vector<Word> words;
+    size_t numBits;
+
+    void clearTail() {
+        if (numBits % bitsPerWord != 0)
+            words.back() &= ~(~(Word)0 << (numBits % bitsPerWord));
+    }
+};
+
+#endif // BITSET_H
@@ -0,0 +1,335 @@
+#ifndef BITSET_KERNELS_H
+#define BITSET_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITSET_KERNELS_X86 1
+#endif
+
+/**
+ * @brief Word-array kernels behind the whole-row operations of BitSet: OR, AND, AND NOT, popcount, the size of an
+ * intersection and whether two rows intersect.
+ *
+ * Each kernel comes in a portable scalar version and, on x86, in AVX2 and AVX-512 versions (the latter needs the
+ * VPOPCNTDQ extension, for the popcounts). The vector versions are compiled with target attributes, so the binary can
+ * be built for a baseline CPU; the set to use is chosen at run time from CPUID (see active()), and the functions at
+ * the end of this file call it. The vector versions handle arrays shorter than a vector with the scalar loop, and
+ * AVX-512 finishes the tail with masked loads.
+ */
+namespace BitSetKernels {
+
+typedef uint64_t Word;
+
+namespace scalar {
+
+inline void orInto(Word* dst, const Word* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] |= src[i];
+}
+
+inline void andInto(Word* dst, const Word* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] &= src[i];
+}
+
+inline void andNotInto(Word* dst, const Word* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] &= ~src[i];
+}
+
+inline size_t popcount(const Word* a, size_t n) {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i) c += __builtin_popcountll(a[i]);
+    return c;
+}
+
+inline size_t intersectionCount(const Word* a, const Word* b, size_t n) {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i) c += __builtin_popcountll(a[i] & b[i]);
+    return c;
+}
+
+inline bool intersects(const Word* a, const Word* b, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (a[i] & b[i]) return true;
+    return false;
+}
+
+} // namespace scalar
+
+#ifdef BITSET_KERNELS_X86
+namespace avx2 {
+
+#define BITSET_AVX2 __attribute__((target("avx2,popcnt")))
+
+BITSET_AVX2 inline void orInto(Word* dst, const Word* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(d, s));
+    }
+    for (; i < n; ++i) dst[i] |= src[i];
+}
+
+BITSET_AVX2 inline void andInto(Word* dst, const Word* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_and_si256(d, s));
+    }
+    for (; i < n; ++i) dst[i] &= src[i];
+}
+
+BITSET_AVX2 inline void andNotInto(Word* dst, const Word* src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_andnot_si256(s, d));
+    }
+    for (; i < n; ++i) dst[i] &= ~src[i];
+}
+
+// bytes counted with a 4-bit lookup table, then summed per 64-bit lane (Mula's method)
+BITSET_AVX2 inline __m256i popcountBytes(__m256i v) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, lowNibbles);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, lo), _mm256_shuffle_epi8(table, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+BITSET_AVX2 inline size_t sumLanes(__m256i v) {
+    return (size_t)_mm256_extract_epi64(v, 0) + (size_t)_mm256_extract_epi64(v, 1)
+         + (size_t)_mm256_extract_epi64(v, 2) + (size_t)_mm256_extract_epi64(v, 3);
+}
+
+BITSET_AVX2 inline size_t popcount(const Word* a, size_t n) {
+    size_t i = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4)
+        sum = _mm256_add_epi64(sum, popcountBytes(_mm256_loadu_si256((const __m256i*)(a + i))));
+    size_t c = sumLanes(sum);
+    for (; i < n; ++i) c += __builtin_popcountll(a[i]);
+    return c;
+}
+
+BITSET_AVX2 inline size_t intersectionCount(const Word* a, const Word* b, size_t n) {
+    size_t i = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        sum = _mm256_add_epi64(sum, popcountBytes(v));
+    }
+    size_t c = sumLanes(sum);
+    for (; i < n; ++i) c += __builtin_popcountll(a[i] & b[i]);
+    return c;
+}
+
+BITSET_AVX2 inline bool intersects(const Word* a, const Word* b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        if (!_mm256_testz_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i))))
+            return true;
+    for (; i < n; ++i)
+        if (a[i] & b[i]) return true;
+    return false;
+}
+
+#undef BITSET_AVX2
+} // namespace avx2
+
+namespace avx512 {
+
+#define BITSET_AVX512 __attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+
+// the last n - i < 8 words
+BITSET_AVX512 inline __mmask8 tailMask(size_t remaining) { return (__mmask8)((1u << remaining) - 1); }
+
+// _mm512_reduce_add_epi64 and _mm512_andnot_si512 trip -Wmaybe-uninitialized in some GCC headers, hence sumLanes()
+// and the all-ones zero-masked AND NOT
+BITSET_AVX512 inline size_t sumLanes(__m512i v) {
+    Word lanes[8];
+    _mm512_storeu_si512(lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+BITSET_AVX512 inline void orInto(Word* dst, const Word* src, size_t n) {
+    if (n < 8) return scalar::orInto(dst, src, n);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_si512(dst + i, _mm512_or_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+    if (i < n) {
+        __mmask8 m = tailMask(n - i);
+        _mm512_mask_storeu_epi64(dst + i, m, _mm512_or_si512(_mm512_maskz_loadu_epi64(m, dst + i), _mm512_maskz_loadu_epi64(m, src + i)));
+    }
+}
+
+BITSET_AVX512 inline void andInto(Word* dst, const Word* src, size_t n) {
+    if (n < 8) return scalar::andInto(dst, src, n);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_si512(dst + i, _mm512_and_si512(_mm512_loadu_si512(dst + i), _mm512_loadu_si512(src + i)));
+    if (i < n) {
+        __mmask8 m = tailMask(n - i);
+        _mm512_mask_storeu_epi64(dst + i, m, _mm512_and_si512(_mm512_maskz_loadu_epi64(m, dst + i), _mm512_maskz_loadu_epi64(m, src + i)));
+    }
+}
+
+BITSET_AVX512 inline void andNotInto(Word* dst, const Word* src, size_t n) {
+    if (n < 8) return scalar::andNotInto(dst, src, n);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_si512(dst + i, _mm512_maskz_andnot_epi64(0xff, _mm512_loadu_si512(src + i), _mm512_loadu_si512(dst + i)));
+    if (i < n) {
+        __mmask8 m = tailMask(n - i);
+        _mm512_mask_storeu_epi64(dst + i, m, _mm512_maskz_andnot_epi64(m, _mm512_maskz_loadu_epi64(m, src + i), _mm512_maskz_loadu_epi64(m, dst + i)));
+    }
+}
+
+BITSET_AVX512 inline size_t popcount(const Word* a, size_t n) {
+    if (n < 8) return scalar::popcount(a, n);
+    size_t i = 0;
+    __m512i sum = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8)
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_loadu_si512(a + i)));
+    if (i < n)
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(tailMask(n - i), a + i)));
+    return sumLanes(sum);
+}
+
+BITSET_AVX512 inline size_t intersectionCount(const Word* a, const Word* b, size_t n) {
+    if (n < 8) return scalar::intersectionCount(a, b, n);
+    size_t i = 0;
+    __m512i sum = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8)
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i))));
+    if (i < n) {
+        __mmask8 m = tailMask(n - i);
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(_mm512_and_si512(_mm512_maskz_loadu_epi64(m, a + i), _mm512_maskz_loadu_epi64(m, b + i))));
+    }
+    return sumLanes(sum);
+}
+
+BITSET_AVX512 inline bool intersects(const Word* a, const Word* b, size_t n) {
+    if (n < 8) return scalar::intersects(a, b, n);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        if (_mm512_test_epi64_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)))
+            return true;
+    if (i < n) {
+        __mmask8 m = tailMask(n - i);
+        return _mm512_test_epi64_mask(_mm512_maskz_loadu_epi64(m, a + i), _mm512_maskz_loadu_epi64(m, b + i)) != 0;
+    }
+    return false;
+}
+
+#undef BITSET_AVX512
+} // namespace avx512
+#endif // BITSET_KERNELS_X86
+
+/**
+ * @brief One implementation of every kernel
+ */
+struct KernelSet {
+    const char* name;
+    void (*orInto)(Word* dst, const Word* src, size_t n);
+    void (*andInto)(Word* dst, const Word* src, size_t n);
+    void (*andNotInto)(Word* dst, const Word* src, size_t n);
+    size_t (*popcount)(const Word* a, size_t n);
+    size_t (*intersectionCount)(const Word* a, const Word* b, size_t n);
+    bool (*intersects)(const Word* a, const Word* b, size_t n);
+};
+
+inline const KernelSet& scalarKernels() {
+    static const KernelSet k = {"scalar", scalar::orInto, scalar::andInto, scalar::andNotInto,
+                                scalar::popcount, scalar::intersectionCount, scalar::intersects};
+    return k;
+}
+
+/**
+ * @brief The kernel set called #name ("scalar", "avx2" or "avx512"); nullptr if there is none or this CPU cannot
+ * run it
+ */
+inline const KernelSet* find(const std::string& name) {
+    if (name == "scalar") return &scalarKernels();
+#ifdef BITSET_KERNELS_X86
+    if (name == "avx2" && __builtin_cpu_supports("avx2")) {
+        static const KernelSet k = {"avx2", avx2::orInto, avx2::andInto, avx2::andNotInto,
+                                    avx2::popcount, avx2::intersectionCount, avx2::intersects};
+        return &k;
+    }
+    if (name == "avx512" && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+        static const KernelSet k = {"avx512", avx512::orInto, avx512::andInto, avx512::andNotInto,
+                                    avx512::popcount, avx512::intersectionCount, avx512::intersects};
+        return &k;
+    }
+#endif
+    return nullptr;
+}
+
+/**
+ * @brief The fastest kernel set this CPU runs
+ */
+inline const KernelSet& best() {
+    const char* names[] = {"avx512", "avx2"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        if (const KernelSet* k = find(names[i])) return *k;
+    return scalarKernels();
+}
+
+// chosen from CPUID the first time a kernel runs
+inline const KernelSet*& activeSlot() {
+    static const KernelSet* k = &best();
+    return k;
+}
+
+/**
+ * @brief The kernel set the whole-row operations of BitSet use
+ */
+inline const KernelSet& active() { return *activeSlot(); }
+
+/**
+ * @brief Make the set called #name active, or the best one for "auto"; call it before any search starts
+ * @return false, leaving the active set as it was, if this CPU cannot run the set
+ */
+inline bool select(const std::string& name) {
+    const KernelSet* k = (name == "auto" ? &best() : find(name));
+    if (k) activeSlot() = k;
+    return k != nullptr;
+}
+
+// Rows of fewer words than this are short enough that the inlined scalar loop beats an indirect call.
+static const size_t dispatchMinWords = 4;
+
+inline void orInto(Word* dst, const Word* src, size_t n) {
+    if (n < dispatchMinWords) scalar::orInto(dst, src, n); else active().orInto(dst, src, n);
+}
+
+inline void andInto(Word* dst, const Word* src, size_t n) {
+    if (n < dispatchMinWords) scalar::andInto(dst, src, n); else active().andInto(dst, src, n);
+}
+
+inline void andNotInto(Word* dst, const Word* src, size_t n) {
+    if (n < dispatchMinWords) scalar::andNotInto(dst, src, n); else active().andNotInto(dst, src, n);
+}
+
+inline size_t popcount(const Word* a, size_t n) {
+    return n < dispatchMinWords ? scalar::popcount(a, n) : active().popcount(a, n);
+}
+
+inline size_t intersectionCount(const Word* a, const Word* b, size_t n) {
+    return n < dispatchMinWords ? scalar::intersectionCount(a, b, n) : active().intersectionCount(a, b, n);
+}
+
+inline bool intersects(const Word* a, const Word* b, size_t n) {
+    return n < dispatchMinWords ? scalar::intersects(a, b, n) : active().intersects(a, b, n);
+}
+
+} // namespace BitSetKernels
+
+#endif // BITSET_KERNELS_H
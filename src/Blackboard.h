@@ -0,0 +1,69 @@
+#ifndef BLACKBOARD_H
+#define BLACKBOARD_H
+
+#include <atomic>
+#include <limits>
+
+/**
+ * @brief A flag that asks cooperating searches to stop; each search polls it and winds down on its own
+ */
+class CancellationToken {
+public:
+    CancellationToken() : cancelled(false) {}
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled;
+};
+
+/**
+ * @brief Bounds on the chromatic number of one graph, shared by searches running concurrently on it.
+ *
+ * Both bounds only move towards each other, by compare-and-swap, so no search ever waits for another one. Once they
+ * meet, the chromatic number is known and the token is cancelled.
+ */
+class Blackboard {
+public:
+    Blackboard(CancellationToken& token, int lowerBound) :
+        token(token), lowerBound(lowerBound), upperBound(std::numeric_limits<int>::max()) {}
+
+    int getLowerBound() const { return lowerBound.load(); }
+    int getUpperBound() const { return upperBound.load(); }
+
+    /**
+     * @brief Publish a proof that the chromatic number is at least #bound
+     */
+    void raiseLowerBound(int bound) {
+        int current = lowerBound.load();
+        while (bound > current && !lowerBound.compare_exchange_weak(current, bound)) {}
+        checkSolved();
+    }
+
+    /**
+     * @brief Publish a coloring with #bound colors
+     * @return true if it is better than every coloring published before
+     */
+    bool offerUpperBound(int bound) {
+        int current = upperBound.load();
+        while (bound < current) {
+            if (upperBound.compare_exchange_weak(current, bound)) {
+                checkSolved();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    CancellationToken& token;
+    std::atomic<int> lowerBound;
+    std::atomic<int> upperBound;
+
+    void checkSolved() {
+        if (getLowerBound() >= getUpperBound()) token.cancel();
+    }
+};
+
+#endif // BLACKBOARD_H
@@ -0,0 +1,201 @@
+#ifndef COMPONENT_DECOMPOSITION_H
+#define COMPONENT_DECOMPOSITION_H
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include "Graph.h"
+#include "VertexColoring.h"
+#include "DsaturColoring.h"
+#include "KColorability.h"
+#include "Portfolio.h"
+#include "SolverOptions.h"
+#ifdef USE_MPI
+#include "MpiBranchAndBound.h"
+#endif
+
+/**
+ * @brief Colors a graph component by component.
+ *
+ * The chromatic number of a graph is the maximum over its connected components, and components can be colored
+ * independently with the same set of colors. Each component's induced subgraph is solved as an OpenMP task;
+ * the largest lower bound proven so far is shared between the tasks, so a component whose coloring already reaches
+ * it cannot raise the maximum and its search stops right away. With the work-stealing search or the portfolio, or when
+ * at most one component needs a search, the components are solved one after the other outside of the team instead, so
+ * that each search can use all threads.
+ * In distributed mode the components are solved one after the other, each by all MPI ranks together.
+ */
+template<class VectorT>
+class ComponentDecomposition {
+public:
+    typedef typename Graph<VectorT>::VertexId VertexId;
+
+    ComponentDecomposition(const Graph<VectorT>& g, const SolverOptions& options) : graph(g), options(options), numSkipped(0), provenLowerBound(0), numNodes(0) {
+        components = graph.getConnectedComponents();
+        // largest components first, they are the most likely to determine the maximum
+        std::stable_sort(components.begin(), components.end(),
+            [](const std::vector<VertexId>& a, const std::vector<VertexId>& b) { return a.size() > b.size(); });
+    }
+
+    /**
+     * @brief Color all components concurrently
+     * @param lowerBound    a known lower bound on the chromatic number of the whole graph
+     * @return the number of colors used by getColoring(); optimal unless a search stopped at the deadline, which
+     *         getLowerBound() then falls short of
+     */
+    int solve(int lowerBound) {
+#ifdef USE_MPI
+        if (options.distributed)
+            return solveDistributed(lowerBound);
+#endif
+        coloring.assign(graph.getNumVertices(), -1);
+        std::atomic<int> sharedLowerBound(lowerBound);
+        std::atomic<int> numColors(0);
+        numSkipped = 0;
+        numNodes = 0;
+
+        if (searchOneAtATime(lowerBound)) {
+            for (size_t c = 0; c < components.size(); ++c)
+                colorComponent(c, sharedLowerBound, numColors);
+        } else {
+            #pragma omp parallel
+            #pragma omp single
+            for (size_t c = 0; c < components.size(); ++c) {
+                #pragma omp task firstprivate(c) shared(sharedLowerBound, numColors)
+                colorComponent(c, sharedLowerBound, numColors);
+            }
+        }
+
+        provenLowerBound = sharedLowerBound.load();
+        return numColors.load();
+    }
+
+    const std::vector<int>& getColoring() const { return coloring; }
+
+    /**
+     * @brief The lower bound on the chromatic number of the whole graph proven by solve()
+     */
+    int getLowerBound() const { return provenLowerBound; }
+    size_t getNumComponents() const { return components.size(); }
+
+    /**
+     * @brief Number of components that were colored within the shared bound without an exact search
+     */
+    size_t getNumSkipped() const { return numSkipped.load(); }
+
+    /**
+     * @brief Number of search nodes of all components, summed over the engines (see their getNumNodes())
+     */
+    long getNumNodes() const { return numNodes.load(); }
+
+private:
+#ifdef USE_MPI
+    /**
+     * @brief Color the components in order, searching each of them with MpiBranchAndBound; every rank makes the same
+     * calls with the same bounds, so all of them end with the same coloring
+     */
+    int solveDistributed(int lowerBound) {
+        coloring.assign(graph.getNumVertices(), -1);
+        int numColors = 0;
+        numSkipped = 0;
+        numNodes = 0;
+        for (size_t c = 0; c < components.size(); ++c) {
+            const std::vector<VertexId>& vertices = components[c];
+            int componentColors;
+            if ((int)vertices.size() <= lowerBound) {
+                for (size_t i = 0; i < vertices.size(); ++i)
+                    coloring[vertices[i]] = i;
+                componentColors = vertices.size();
+                numSkipped++;
+            } else {
+                Graph<VectorT> subgraph = graph.inducedSubgraph(vertices);
+                MpiBranchAndBound<VectorT> solver(subgraph, options);
+                componentColors = solver.solve(lowerBound);
+                for (size_t i = 0; i < vertices.size(); ++i)
+                    coloring[vertices[i]] = solver.getColoring()[i];
+                lowerBound = std::max(lowerBound, solver.getLowerBound());
+                numNodes += solver.getNumNodes();
+            }
+            numColors = std::max(numColors, componentColors);
+        }
+        provenLowerBound = lowerBound;
+        return numColors;
+    }
+#endif
+
+    /**
+     * @brief Whether to search the components one after the other, each with all threads, instead of as concurrent
+     * tasks: the work-stealing search starts its own parallel region, which gets a single thread inside the team of
+     * the tasks, the portfolio starts threads of its own for all cores, which would run once per component next to
+     * the team, and with at most one component to search there is nothing to run concurrently
+     */
+    bool searchOneAtATime(int lowerBound) const {
+        if (options.searchMode == SolverOptions::search_stealing || options.engine == SolverOptions::engine_portfolio)
+            return true;
+        size_t numSearched = 0;
+        for (size_t c = 0; c < components.size(); ++c)
+            if ((int)components[c].size() > lowerBound) numSearched++;
+        return numSearched <= 1;
+    }
+
+    /**
+     * @brief Color component #c: with distinct colors if it has no more vertices than the shared bound, otherwise by
+     * an exact search with the engine of the options
+     */
+    void colorComponent(size_t c, std::atomic<int>& sharedLowerBound, std::atomic<int>& numColors) {
+        const std::vector<VertexId>& vertices = components[c];
+        int bound = sharedLowerBound.load();
+        int componentColors;
+        if ((int)vertices.size() <= bound) {
+            // any coloring of this component with distinct colors is within the bound
+            for (size_t i = 0; i < vertices.size(); ++i)
+                coloring[vertices[i]] = i;
+            componentColors = vertices.size();
+            numSkipped++;
+        } else {
+            Graph<VectorT> subgraph = graph.inducedSubgraph(vertices);
+            if (options.engine == SolverOptions::engine_dsatur) {
+                DsaturColoring<VectorT> solver(subgraph, options);
+                componentColors = solveComponent(solver, vertices, bound, sharedLowerBound);
+            } else if (options.engine == SolverOptions::engine_cdcl) {
+                KColorability<VectorT> solver(subgraph, options);
+                componentColors = solveComponent(solver, vertices, bound, sharedLowerBound);
+            } else if (options.engine == SolverOptions::engine_portfolio) {
+                Portfolio<VectorT> solver(subgraph, options);
+                componentColors = solveComponent(solver, vertices, bound, sharedLowerBound);
+            } else {
+                VertexColoring<VectorT> solver(subgraph, options);
+                componentColors = solveComponent(solver, vertices, bound, sharedLowerBound);
+            }
+        }
+        atomicMax(numColors, componentColors);
+    }
+
+    /**
+     * @brief Run an exact #solver on a component and copy its coloring to the component's vertices
+     */
+    template<class Solver>
+    int solveComponent(Solver& solver, const std::vector<VertexId>& vertices, int bound, std::atomic<int>& sharedLowerBound) {
+        int componentColors = solver.findChromaticNumber(bound);
+        for (size_t i = 0; i < vertices.size(); ++i)
+            coloring[vertices[i]] = solver.bestColoring[i];
+        atomicMax(sharedLowerBound, solver.getLowerBound());
+        numNodes += solver.getNumNodes();
+        return componentColors;
+    }
+
+    const Graph<VectorT>& graph;
+    const SolverOptions& options;
+    std::vector<std::vector<VertexId> > components;
+    std::vector<int> coloring;
+    std::atomic<size_t> numSkipped;
+    int provenLowerBound;
+    std::atomic<long> numNodes;
+
+    static void atomicMax(std::atomic<int>& target, int value) {
+        int current = target.load();
+        while (current < value && !target.compare_exchange_weak(current, value)) {}
+    }
+};
+
+#endif // COMPONENT_DECOMPOSITION_H
@@ -0,0 +1,294 @@
+#ifndef DSATUR_COLORING_H
+#define DSATUR_COLORING_H
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <atomic>
+#include <functional>
+#include "BitSet.h"
+#include "Graph.h"
+#include "SolverOptions.h"
+#include "SearchStats.h"
+#include "ProgressTrace.h"
+
+/**
+ * @brief Exact coloring by DSATUR branch and bound (Brélaz, as in Trick's trick.c).
+ *
+ * Vertices are colored one at a time; the next vertex is the uncolored one with the most distinct colors among its
+ * neighbours (its saturation), ties broken by the number of uncolored neighbours. The search branches on every color
+ * the vertex may take: each color already in use that no neighbour has, and one new color, as long as fewer colors
+ * than in the best coloring are used. A clique is colored before the search, which also removes the symmetry of
+ * permuting its colors, and its size is the lower bound that ends the search early. Below the root, a greedy clique on
+ * the uncolored vertices bounds the colors every completion needs (see nodeLowerBound()), which prunes the node when
+ * that reaches the best coloring.
+ *
+ * The colors forbidden for each vertex are kept as a bitset, the uncolored vertices in bitset buckets keyed by their
+ * saturation, and each color class as a bitset of vertices; the search runs on an explicit stack and undoes every
+ * assignment when it backtracks.
+ */
+template<class VectorT>
+class DsaturColoring {
+public:
+    Graph<VectorT>& graph;
+    std::vector<int> bestColoring;
+
+    DsaturColoring(Graph<VectorT>& g, const SolverOptions& options = SolverOptions()) :
+        graph(g), options(options), lowerBound(0), upperBound(g.getNumVertices() + 1), numNodes(0),
+        stopRequested(false), pollInterval(1) {}
+
+    /**
+     * @brief Find the chromatic number of the graph and store the coloring in #bestColoring
+     * @param knownLowerBound   see VertexColoring::findChromaticNumber
+     * @return the number of colors used by #bestColoring; if the deadline of the options passed before the search
+     *         ended, getLowerBound() may be below it
+     */
+    int findChromaticNumber(int knownLowerBound = 0) {
+        int n = graph.getNumVertices();
+        initialize();
+        VectorT clique = graph.findMaxCliqueApprox();
+        lowerBound = std::max<int>(clique.size(), knownLowerBound);
+        for (size_t i = 0; i < clique.size(); ++i)
+            assign(clique[i], i);
+        trace.start("dsatur", n);
+        traceProgress(ProgressTrace::event_start);
+        if (numColored == n) {
+            recordColoring();
+            traceProgress(ProgressTrace::event_end);
+            return upperBound;
+        }
+
+        std::vector<Frame> stack;
+        stack.reserve(n);
+        stack.push_back(Frame{selectVertex(), 0, -1});
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.color >= 0) {
+                unassign(frame.vertex, frame.color);
+                frame.color = -1;
+            }
+
+            // a new color is allowed only while the coloring stays below the best one; after the best coloring
+            // improved, the colors fixed above this level may already be too many
+            int lastColor = std::min(numUsedColors, upperBound - 2);
+            int c = frame.nextColor;
+            while (c <= lastColor && forbidden[frame.vertex][c]) ++c;
+            if (c > lastColor || numUsedColors >= upperBound || lowerBound >= upperBound) {
+                stack.pop_back();
+                continue;
+            }
+
+            // stop at the deadline or on request, but not before there is a coloring or an imported bound
+            numNodes++;
+            SearchStats::count(SearchStats::nodes_expanded);
+            if (pollCallback && numNodes % pollInterval == 0)
+                pollCallback();
+            if (numNodes % deadlineCheckInterval == 0) {
+                if (options.deadlinePassed())
+                    stopRequested = true;
+                trace.poll(numNodes, lowerBound, std::min(upperBound, n), stack.size(), numColored);
+            }
+            if (stopRequested && (!bestColoring.empty() || upperBound <= n)) {
+                traceProgress(ProgressTrace::event_end);
+                return upperBound;
+            }
+            assign(frame.vertex, c);
+            frame.color = c;
+            frame.nextColor = c + 1;
+            if (numColored == n) {
+                recordColoring();
+                continue;
+            }
+            if (nodeLowerBound() >= upperBound) {
+                SearchStats::count(SearchStats::nodes_pruned);
+                continue;
+            }
+            stack.push_back(Frame{selectVertex(), 0, -1});
+        }
+        lowerBound = upperBound;
+        traceProgress(ProgressTrace::event_end);
+        return upperBound;
+    }
+
+    int getLowerBound() const { return lowerBound; }
+    int getUpperBound() const { return upperBound; }
+    long getNumNodes() const { return numNodes; }
+
+    /**
+     * @brief Lower the upper bound used for pruning to #bound, found elsewhere; to be called from the poll callback.
+     * #bestColoring only gets replaced by colorings with fewer colors than that.
+     */
+    void importUpperBound(int bound) {
+        if (bound >= upperBound) return;
+        upperBound = bound;
+        traceProgress(ProgressTrace::event_bound);
+    }
+
+    /**
+     * @brief Make the search return as soon as possible; #bestColoring keeps the best coloring found so far
+     */
+    void requestStop() { stopRequested = true; }
+    bool isStopRequested() const { return stopRequested.load(); }
+
+    /**
+     * @brief Call #callback after every #interval search nodes
+     */
+    void setPollCallback(long interval, std::function<void()> callback) {
+        pollInterval = interval;
+        pollCallback = callback;
+    }
+
+private:
+    /**
+     * @brief A branching level: the vertex colored there, its current color (-1 if none) and the next color to try
+     */
+    struct Frame {
+        int vertex;
+        int nextColor;
+        int color;
+    };
+
+    static const long deadlineCheckInterval = 1024;    // nodes between two reads of the clock
+
+    SolverOptions options;
+    int lowerBound;
+    int upperBound;
+    long numNodes;
+    std::atomic<bool> stopRequested;
+    long pollInterval;
+    std::function<void()> pollCallback;
+    ProgressTrace::Source trace;
+
+    std::vector<int> coloring;
+    std::vector<BitSet> forbidden;          // forbidden[v]: colors of v's colored neighbours
+    std::vector<BitSet> colorClasses;       // colorClasses[c]: vertices colored c
+    std::vector<BitSet> buckets;            // buckets[s]: uncolored vertices with saturation s
+    std::vector<int> saturation;
+    std::vector<int> uncoloredDegree;
+    std::vector<int> colorClassSize;
+    int numUsedColors;                      // colors 0 .. numUsedColors-1 are in use
+    int numColored;
+    int maxSaturation;                      // no bucket above this one is non-empty
+    BitSet cliqueCandidates;                // scratch of nodeLowerBound()
+    BitSet commonForbidden;
+
+    void initialize() {
+        int n = graph.getNumVertices();
+        coloring.assign(n, -1);
+        forbidden.assign(n, BitSet(n + 1));
+        colorClasses.assign(n + 1, BitSet(n));
+        buckets.assign(n + 1, BitSet(n));
+        saturation.assign(n, 0);
+        uncoloredDegree.resize(n);
+        colorClassSize.assign(n + 1, 0);
+        for (int v = 0; v < n; ++v) {
+            uncoloredDegree[v] = graph.adjacencyMatrix[v].count();
+            buckets[0].set(v);
+        }
+        cliqueCandidates.resize(n);
+        commonForbidden.resize(n + 1);
+        numUsedColors = 0;
+        numColored = 0;
+        maxSaturation = 0;
+        numNodes = 0;
+    }
+
+    void moveToBucket(int v, int s) {
+        buckets[saturation[v]].reset(v);
+        saturation[v] = s;
+        buckets[s].set(v);
+        maxSaturation = std::max(maxSaturation, s);
+    }
+
+    /**
+     * @brief The uncolored vertex with the largest saturation, ties broken by the largest number of uncolored neighbours
+     */
+    int selectVertex() {
+        while (maxSaturation > 0 && buckets[maxSaturation].none()) maxSaturation--;
+        int best = -1;
+        buckets[maxSaturation].forEach([&](size_t v) {
+            if (best < 0 || uncoloredDegree[v] > uncoloredDegree[best]) best = v;
+        });
+        return best;
+    }
+
+    /**
+     * @brief A lower bound on the colors of every completion of the current partial coloring, from a clique K of
+     * uncolored vertices, taken greedily in order of decreasing saturation.
+     *
+     * The vertices of K need distinct colors. Each one whose used colors are all forbidden needs a new color. Also, at
+     * most |U| of them can take a used color, where U is the set of used colors that some vertex of K may still take;
+     * the others need new colors too. The bound is the number of used colors plus the larger of the two counts.
+     */
+    int nodeLowerBound() {
+        cliqueCandidates.setAll();
+        commonForbidden.setAll();
+        int cliqueSize = 0, numSaturated = 0;
+        for (int s = maxSaturation; s >= 0; --s) {
+            buckets[s].forEach([&](size_t v) {
+                if (!cliqueCandidates[v]) return;
+                cliqueSize++;
+                if (s == numUsedColors) numSaturated++;
+                cliqueCandidates &= graph.adjacencyMatrix[v];
+                commonForbidden &= forbidden[v];
+            });
+        }
+        // forbidden colors are used colors, so U is the used colors minus those forbidden for all of K
+        int numUsable = numUsedColors - (int)commonForbidden.count();
+        return numUsedColors + std::max(numSaturated, cliqueSize - numUsable);
+    }
+
+    void assign(int v, int c) {
+        coloring[v] = c;
+        colorClasses[c].set(v);
+        if (colorClassSize[c]++ == 0) numUsedColors = std::max(numUsedColors, c + 1);
+        buckets[saturation[v]].reset(v);
+        numColored++;
+        graph.adjacencyMatrix[v].forEach([&](size_t u) {
+            if (coloring[u] >= 0) return;
+            uncoloredDegree[u]--;
+            if (!forbidden[u][c]) {
+                forbidden[u].set(c);
+                moveToBucket(u, saturation[u] + 1);
+            }
+        });
+    }
+
+    /**
+     * @brief Undo #assign(v, c); c stays forbidden for a neighbour that has another neighbour colored c
+     */
+    void unassign(int v, int c) {
+        coloring[v] = -1;
+        colorClasses[c].reset(v);
+        colorClassSize[c]--;
+        while (numUsedColors > 0 && colorClassSize[numUsedColors - 1] == 0) numUsedColors--;
+        numColored--;
+        graph.adjacencyMatrix[v].forEach([&](size_t u) {
+            if (coloring[u] >= 0) return;
+            uncoloredDegree[u]++;
+            if (!graph.adjacencyMatrix[u].intersects(colorClasses[c])) {
+                forbidden[u].reset(c);
+                moveToBucket(u, saturation[u] - 1);
+            }
+        });
+        buckets[saturation[v]].set(v);
+        maxSaturation = std::max(maxSaturation, saturation[v]);
+    }
+
+    void recordColoring() {
+        upperBound = numUsedColors;
+        bestColoring = coloring;
+        traceProgress(ProgressTrace::event_bound);
+        if (options.debugOutput)
+            std::cout << "DSATUR: coloring with " << upperBound << " colors after " << numNodes << " nodes" << std::endl;
+    }
+
+    /**
+     * @brief Write the bounds to the progress trace; the upper bound is the number of vertices until there is a coloring
+     */
+    void traceProgress(ProgressTrace::Event event) {
+        trace.record(event, numNodes, lowerBound, std::min<int>(upperBound, graph.getNumVertices()));
+    }
+};
+
+#endif // DSATUR_COLORING_H
@@ -14,6 +14,10 @@
 #include <bitset>
 #include <map>
 #include <numeric>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "BitSet.h"
 #include "GraphLabels.h"
 
 template<class VectorT>
@@ -21,10 +25,13 @@ class Graph {
 public:
     typedef typename VectorT::VertexId VertexId;
     typedef VectorT VertexSet;
+    typedef BitSet AdjacencyRow;
 
     const long int adjacencyMatrixMaxNodes = 10000;      // 1000 nodes translates into 1M node total matrix size, and 10000 -> 100M
+    static const unsigned int parallelCoreDecompositionMinNodes = 4096;  // below this size the sequential peeling is faster
+    static const unsigned int parallelVerificationMinNodes = 4096;       // below this size one thread checks a coloring faster
     bool wasRemapedTo0based = false;                 // this will be set to true if graph is loaded from a file type that is 1-based
-    std::vector<VectorT> adjacencyMatrix, invAdjacencyMatrix;
+    std::vector<AdjacencyRow> adjacencyMatrix, invAdjacencyMatrix;
     std::vector<int> degrees;
     std::vector<VertexId> mapping;
     // by default, labels are empty, and for all uses, the graph should be considered unlabelled
@@ -117,19 +124,8 @@ public:
     void invertEdges() {
         size_t n = adjacencyMatrix.size();
         for (size_t i = 0; i < n; ++i) {
-            if (isTypeASet<VectorT>::value) {
-                for (size_t j = 0; j < n; ++j) {
-                    adjacencyMatrix[i][j] = !adjacencyMatrix[i][j];
-                    invAdjacencyMatrix[i][j] = !invAdjacencyMatrix[i][j];
-                }
-                invAdjacencyMatrix[i][i] = false;
-                adjacencyMatrix[i][i] = false;
-            } else {
-                // MD: this branch of code has not been verified yet
-                auto temp = adjacencyMatrix[i];
-                adjacencyMatrix[i] = invAdjacencyMatrix[i];
-                invAdjacencyMatrix[i] = temp;
-            }
+            // rows are kept as exact complements (without the diagonal), so swapping them inverts the graph
+            std::swap(adjacencyMatrix[i], invAdjacencyMatrix[i]);
             degrees[i] = n-degrees[i]-1;
         }
         labels.clearEdgeLabels();
@@ -159,44 +155,44 @@ public:
     }
     
     /**
-     * @brief Initialize from adjacency matrix and degrees
+     * @brief Initialize from adjacency matrix; the degrees are counted from the matrix, since a loader that counts
+     * edge lines counts an edge listed twice twice
      * 
      * @param adjacency the adjacency matrix for verices 
-     * @param d         the vector of vertex degrees
      */
-    void init(const std::vector<std::vector<char> >& adjacency, const std::vector<int>& d) {
+    void init(const std::vector<std::vector<char> >& adjacency) {
         size_t n = adjacency.size();
         adjacencyMatrix.resize(n); 
         invAdjacencyMatrix.resize(n); 
         for (size_t i = 0; i < n; ++i) {
+            adjacencyMatrix[i].clear();
             adjacencyMatrix[i].resize(n, false);
-            invAdjacencyMatrix[i].resize(n, false);
-            invAdjacencyMatrix[i][i] = false;
-            for (size_t j = i+1; j < adjacency[i].size(); ++j) {
-                adjacencyMatrix[i][j] = adjacency[i][j];
-                invAdjacencyMatrix[i][j] = (adjacency[i][j] == false);
-            }
+            invAdjacencyMatrix[i].clear();
+            invAdjacencyMatrix[i].resize(n, true);
+            invAdjacencyMatrix[i].reset(i);
         }
         for (size_t i = 0; i < n; ++i) {
-            for (size_t j = 0; j < i; ++j) {
-                adjacencyMatrix[i][j] = adjacency[j][i];
-                invAdjacencyMatrix[i][j] = (adjacency[j][i] == false);
+            for (size_t j = i+1; j < adjacency[i].size(); ++j) {
+                if (adjacency[i][j]) {
+                    adjacencyMatrix[i].set(j);
+                    adjacencyMatrix[j].set(i);
+                    invAdjacencyMatrix[i].reset(j);
+                    invAdjacencyMatrix[j].reset(i);
+                }
             }
         }
-        degrees = d;
+        calculateNodeDegrees();
         mapping.clear();
     }
 
     /**
-     * @brief Initialize from adjacency matrix, degrees, and labels (for vertices and edges)
+     * @brief Initialize from adjacency matrix and labels (for vertices and edges)
      * 
      * @param adjacency the adjacency matrix of vertices
-     * @param d         vector of vertex degrees
      * @param labels    labels for vertices and/or edges
      */
-    void init(const std::vector<std::vector<char> >& adjacency, 
-        const std::vector<int>& d, const GraphLabels<uint16_t>& labels) {
-        init(adjacency, d);
+    void init(const std::vector<std::vector<char> >& adjacency, const GraphLabels<uint16_t>& labels) {
+        init(adjacency);
         this->labels = labels;
     }
     
@@ -205,166 +201,236 @@ public:
      */
     void calculateNodeDegrees() {
         size_t n = adjacencyMatrix.size();
-        degrees.resize(n, 0);
+        degrees.resize(n);
         for (size_t i = 0; i < n; ++i) {
-            for (size_t j = i+1; j < n; ++j) {
-                if (adjacencyMatrix[i][j]) {
-                    degrees[i]++;
-                    degrees[j]++;
-                }
-            }
+            degrees[i] = adjacencyMatrix[i].count();
         }
     }
 
     /**
-     * @brief Compute the k-core decomposition of the graph using Batagelj-Zaversnik algorithm
-     * @return Vector containing the core number for each vertex
+     * @brief Result of the k-core decomposition
      */
-    std::vector<int> computeCoreDecomposition() {
-        size_t n = getNumVertices();
-        // Initialize degrees if not already calculated
-        if (degrees.empty()) {
-            calculateNodeDegrees();
-        }
+    struct CoreDecomposition {
+        std::vector<int> coreNumbers;           // core number of each vertex
+        std::vector<VertexId> degeneracyOrder;  // vertices in the order they were peeled off (smallest core first)
+        int degeneracy;                         // the largest core number
 
-        // Create a copy of degrees that we'll modify
-        std::vector<int> vertexDegrees = degrees;
-
-        // Core numbers for each vertex
-        std::vector<int> coreNumbers(n);
-
-        // Create array of vertices
-        std::vector<VertexId> vertices(n);
-        std::iota(vertices.begin(), vertices.end(), 0);
+        CoreDecomposition() : degeneracy(0) {}
+    };
 
-        // Sort vertices by degree
-        std::vector<int> pos(n);
-        std::vector<VertexId> degBins(n + 1, 0);
+    /**
+     * @brief Compute the k-core decomposition of the graph using Batagelj-Zaversnik algorithm
+     * 
+     * Neighbours are visited by iterating the set bits of adjacency rows, so the cost is O(n²/64 + m) instead of O(n²).
+     * For large graphs (and when not already running inside a parallel region) the parallel peeling variant is used instead.
+     * @return core numbers of all vertices and the degeneracy order
+     */
+    CoreDecomposition computeCoreDecomposition() const {
+#ifdef _OPENMP
+        if (getNumVertices() >= parallelCoreDecompositionMinNodes && omp_get_max_threads() > 1 && !omp_in_parallel())
+            return computeCoreDecompositionParallel();
+#endif
+        return computeCoreDecompositionSequential();
+    }
 
-        // Count frequency of each degree
-        for (size_t v = 0; v < n; v++) {
-            degBins[vertexDegrees[v]]++;
-        }
+    /**
+     * @brief Sequential bucket-based Batagelj-Zaversnik core decomposition, O(n²/64 + m)
+     */
+    CoreDecomposition computeCoreDecompositionSequential() const {
+        CoreDecomposition result;
+        std::vector<int> bin, pos;
+        computeCoreDecompositionSequential(result, bin, pos);
+        return result;
+    }
 
-        
-        // Starting positions of vertices of each degree
-        int start = 0;
-        for (size_t d = 0; d <= n; d++) {
-            int num = degBins[d];
-            degBins[d] = start;
+    /**
+     * @brief The same, into #result, with #bin and #pos as scratch space; reuses the capacity of all of them
+     */
+    void computeCoreDecompositionSequential(CoreDecomposition& result, std::vector<int>& bin, std::vector<int>& pos) const {
+        size_t n = getNumVertices();
+        std::vector<int>& deg = result.coreNumbers;
+        std::vector<VertexId>& vert = result.degeneracyOrder;
+        deg.resize(n);
+        vert.resize(n);
+        result.degeneracy = 0;
+        if (n == 0) return;
+
+        // degrees are recomputed from the rows, so they are exact even if #degrees was not maintained
+        int maxDeg = 0;
+        for (size_t v = 0; v < n; ++v) {
+            deg[v] = adjacencyMatrix[v].count();
+            maxDeg = std::max(maxDeg, deg[v]);
+        }
+
+        // bin[d] = index in #vert of the first vertex with (current) degree d
+        bin.assign(maxDeg + 1, 0);
+        pos.resize(n);
+        for (size_t v = 0; v < n; ++v)
+            bin[deg[v]]++;
+        for (int d = 0, start = 0; d <= maxDeg; ++d) {
+            int num = bin[d];
+            bin[d] = start;
             start += num;
         }
+        for (size_t v = 0; v < n; ++v) {
+            pos[v] = bin[deg[v]]++;
+            vert[pos[v]] = v;
+        }
+        for (int d = maxDeg; d > 0; --d)
+            bin[d] = bin[d-1];
+        bin[0] = 0;
 
-
-        // Sort vertices by degree in ascending order
-        for (size_t v = 0; v < n; v++) {
-            if (vertexDegrees[v] >= 0 && vertexDegrees[v] <= n) {
-                pos[v] = degBins[vertexDegrees[v]];
-                if (pos[v] >= 0 && pos[v] < n) {
-                    vertices[pos[v]] = v;
-                    degBins[vertexDegrees[v]]++;
+        // peel vertices in ascending order of degree; once processed, deg[v] is the core number of v
+        for (size_t i = 0; i < n; ++i) {
+            VertexId v = vert[i];
+            int dv = deg[v];
+            adjacencyMatrix[v].forEach([&](size_t u) {
+                int du = deg[u];
+                if (du > dv) {
+                    // move u to the front of its bin, then shrink the bin by one
+                    int pu = pos[u];
+                    int pw = bin[du];
+                    VertexId w = vert[pw];
+                    if (u != (size_t)w) {
+                        pos[u] = pw;
+                        vert[pu] = w;
+                        pos[w] = pu;
+                        vert[pw] = u;
+                    }
+                    bin[du]++;
+                    deg[u]--;
                 }
-            }
+            });
         }
 
-        // Restore starting positions
-        for (int d = n; d > 0; d--) {
-            degBins[d] = degBins[d-1];
-        }
-        degBins[0] = 0;
+        result.degeneracy = deg[vert[n-1]];
+    }
 
-        // Process vertices in ascending order of degrees
-        for (size_t i = 0; i < n; i++) {
-            VertexId v = vertices[i];
-            if (v >= n) continue; // Skip invalid vertices
-            coreNumbers[v] = vertexDegrees[v];
-            
-            // Update degrees of neighbors
-            for (size_t u = 0; u < n; u++) {
-                // Add bounds checking
-                if (u >= n || v >= n) continue;
-                
-                if (areNeighbours(v, u) && vertexDegrees[u] > vertexDegrees[v]) {
-                    // Get position of u in vertices array
-                    int du = vertexDegrees[u];
-                    int pu = pos[u];
-                    
-                    // Add bounds checking
-                    if (du >= (int)n || du < 0) continue;
-                    int pw = degBins[du];
-                    if (pw >= (int)n || pw < 0) continue;
-                    
-                    VertexId w = vertices[pw];
-                    if (w >= n) continue;
-                    
-                    if (u != w) {
-                        // Swap u and w
-                        if (pu < (int)n && pu >= 0 && pw < (int)n && pw >= 0) {
-                            pos[u] = pw;
-                            pos[w] = pu;
-                            vertices[pu] = w;
-                            vertices[pw] = u;
-                        }
+    /**
+     * @brief Parallel level-synchronous peeling (as in PKC): all vertices of the current level k are peeled concurrently, 
+     * neighbours whose degree drops to k join the next frontier of the same level.
+     * 
+     * The degeneracy order is the order in which frontiers were peeled; vertices within a frontier are in arbitrary order.
+     */
+    CoreDecomposition computeCoreDecompositionParallel() const {
+        long n = getNumVertices();
+        CoreDecomposition result;
+        result.coreNumbers.resize(n);
+        result.degeneracyOrder.reserve(n);
+        if (n == 0) return result;
+
+        std::vector<int> deg(n);
+        std::vector<char> processed(n, false);
+        #pragma omp parallel for schedule(static)
+        for (long v = 0; v < n; ++v)
+            deg[v] = adjacencyMatrix[v].count();
+
+        std::vector<VertexId> frontier, next;
+        long numProcessed = 0;
+        for (int k = 0; numProcessed < n; ++k) {
+            // collect the vertices with degree k
+            frontier.clear();
+            #pragma omp parallel
+            {
+                std::vector<VertexId> local;
+                #pragma omp for schedule(static) nowait
+                for (long v = 0; v < n; ++v)
+                    if (!processed[v] && deg[v] == k)
+                        local.push_back(v);
+                #pragma omp critical
+                frontier.insert(frontier.end(), local.begin(), local.end());
+            }
+
+            while (!frontier.empty()) {
+                for (size_t i = 0; i < frontier.size(); ++i) {
+                    processed[frontier[i]] = true;
+                    result.coreNumbers[frontier[i]] = k;
+                }
+                result.degeneracyOrder.insert(result.degeneracyOrder.end(), frontier.begin(), frontier.end());
+                numProcessed += frontier.size();
+
+                next.clear();
+                #pragma omp parallel
+                {
+                    std::vector<VertexId> local;
+                    #pragma omp for schedule(dynamic, 64) nowait
+                    for (long i = 0; i < (long)frontier.size(); ++i) {
+                        adjacencyMatrix[frontier[i]].forEach([&](size_t u) {
+                            if (!processed[u] && __atomic_load_n(&deg[u], __ATOMIC_RELAXED) > k) {
+                                int old = __atomic_fetch_sub(&deg[u], 1, __ATOMIC_RELAXED);
+                                if (old == k+1)
+                                    local.push_back(u);
+                                else if (old <= k)
+                                    __atomic_fetch_add(&deg[u], 1, __ATOMIC_RELAXED);
+                            }
+                        });
                     }
-                    
-                    degBins[du]++;
-                    vertexDegrees[u]--;
+                    #pragma omp critical
+                    next.insert(next.end(), local.begin(), local.end());
                 }
+                std::swap(frontier, next);
             }
+            result.degeneracy = k;
         }
         
-        return coreNumbers;
+        return result;
     }
 
     /**
      * @brief Find an approximation of the maximum clique using core decomposition
      * @return VectorT containing the vertices that form an approximate maximum clique
      */
-    VectorT findMaxCliqueApprox() {
+    VectorT findMaxCliqueApprox() const {
+        VectorT clique;
+        findMaxCliqueApprox(clique);
+        return clique;
+    }
+
+    /**
+     * @brief The same, into #clique; the scratch buffers are kept per thread, so once they have grown to the size of
+     * the graph a call allocates nothing (the search calls this for every node)
+     */
+    void findMaxCliqueApprox(VectorT& clique) const {
         size_t n = getNumVertices();
+        clique.clear();
+        if (n == 0) return;
 
         // Step 1: Compute core decomposition
-        std::vector<int> coreNumbers = computeCoreDecomposition();
+        static thread_local CoreDecomposition cores;
+        static thread_local std::vector<int> bin, pos;
+#ifdef _OPENMP
+        if (n >= parallelCoreDecompositionMinNodes && omp_get_max_threads() > 1 && !omp_in_parallel())
+            cores = computeCoreDecompositionParallel();
+        else
+#endif
+        computeCoreDecompositionSequential(cores, bin, pos);
+        const std::vector<int>& coreNumbers = cores.coreNumbers;
         
         // Step 2: Sort vertices by descending core number and degree (as tiebreaker)
-        std::vector<std::pair<std::pair<int, int>, VertexId>> sortedVertices;
-        sortedVertices.reserve(n);
+        static thread_local std::vector<std::pair<std::pair<int, int>, VertexId>> sortedVertices;
+        sortedVertices.clear();
         for (size_t i = 0; i < n; i++) {
-            sortedVertices.push_back({{coreNumbers[i], degrees[i]}, i});
+            sortedVertices.push_back({{coreNumbers[i], degrees[i]}, (VertexId)i});
         }
 
         std::sort(sortedVertices.begin(), sortedVertices.end(),
                  std::greater<std::pair<std::pair<int, int>, VertexId>>());
 
-        // Step 3: Build clique starting from highest core number vertex
-        VectorT clique;
-        
-        // Add first vertex (highest core number) to clique
+        // Step 3: Build clique starting from highest core number vertex; #candidates holds the vertices adjacent to
+        // every clique member so far, so testing a vertex is one bit and adding it one row AND
+        static thread_local AdjacencyRow candidates;
         VertexId firstVertex = sortedVertices[0].second;
         clique.push_back(firstVertex);
-        
+        candidates = adjacencyMatrix[firstVertex];
+
         // Try to add each remaining vertex
-        for (size_t i = 1; i < sortedVertices.size(); i++) {
+        for (size_t i = 1; i < sortedVertices.size() && candidates.any(); i++) {
             VertexId v = sortedVertices[i].second;
-            if (v >= getNumVertices()) continue;
-            
-            bool canAdd = true;
-            
-            // Check if v is connected to all vertices already in clique
-            for (size_t j = 0; j < clique.size(); j++) {
-                VertexId u = clique[j];
-                if (u >= getNumVertices() || !areNeighbours(v, u)) {
-                    canAdd = false;
-                    break;
-                }
-            }
-            
-            if (canAdd) {
+            if (candidates.test(v)) {
                 clique.push_back(v);
+                candidates &= adjacencyMatrix[v];
             }
         }
-        
-        return clique;
     }
     
     /**
@@ -430,16 +496,16 @@ public:
         decltype(mapping) mapping2(n);
         
         // remap to temporary adjacencyMatrix
-        std::vector<VectorT> adjacencyMatrix2;
+        std::vector<AdjacencyRow> adjacencyMatrix2;
         adjacencyMatrix2.resize(n);
         for (size_t i = 0; i < n; ++i) {
             adjacencyMatrix2[i].resize(n);
             invAdjacencyMatrix[i].clear();
             invAdjacencyMatrix[i].resize(n);
             mapping2[i] = mapping[order[i]];
-            auto& adjRowI = adjacencyMatrix[order[i]];
+            const auto& adjRowI = adjacencyMatrix[order[i]];
             for (size_t j = 0; j < n; ++j) {
-                adjacencyMatrix2[i][j] = adjRowI[order[j]] == true;
+                adjacencyMatrix2[i][j] = adjRowI[order[j]];
                 invAdjacencyMatrix[i][j] = (i != j) & !adjacencyMatrix2[i][j];
             }
             // the line above includes the condition (i != j) because:
@@ -587,120 +653,74 @@ public:
         return a;
     }
 
-    void removeVerticesWithLowDegree(int n, std::vector<int> maxClique) {
-        size_t originalNumVertices = getNumVertices();
-        std::vector<bool> verticesToRemove(originalNumVertices, false);
-        int numRemoved = 0;
-        // Mark vertices for removal
-        for (size_t i = 0; i < originalNumVertices; ++i) {
-            if (degrees[i] < n) {
-                verticesToRemove[i] = true;
-                numRemoved++;
-            }
-        }
-
-        if (numRemoved == 0) return;
-
-        std::vector<int> filteredVertices = filterVertices(maxClique);
-
-        for (size_t i = 0; i < filteredVertices.size(); ++i) {
-            if (!verticesToRemove[i]){
-                verticesToRemove[i] = true;
-                numRemoved++;
-            }
-        }
-
-
-        std::vector<VectorT> newAdjacencyMatrix;
-        std::vector<VectorT> newInvAdjacencyMatrix;
-        std::vector<int> newDegrees;
-        std::vector<VertexId> newMapping;
-        GraphLabels<VertexId> newLabels;
-        
-
-        newAdjacencyMatrix.reserve(originalNumVertices - numRemoved);
-        newInvAdjacencyMatrix.reserve(originalNumVertices - numRemoved);
-        newDegrees.reserve(originalNumVertices - numRemoved);
-        newMapping.reserve(originalNumVertices - numRemoved);
-
-
-        std::vector<size_t> oldToNewIndex(originalNumVertices, -1);
-
-        size_t newIndex = 0;
-        for (size_t i = 0; i < originalNumVertices; ++i) {
-            if (!verticesToRemove[i]) {
-                oldToNewIndex[i] = newIndex++;
-                newDegrees.push_back(degrees[i]);
-                newMapping.push_back(mapping.empty() ? i : mapping[i]);
-                if (labels.vertexLabels.size() == originalNumVertices)
-                    newLabels.vertexLabels.push_back(labels.vertexLabels[i]);
-
-                newAdjacencyMatrix.emplace_back();
-                newInvAdjacencyMatrix.emplace_back();
-            }
-        }
-
-
-
-        for (size_t i = 0; i < newIndex; ++i) {
-            newAdjacencyMatrix[i].resize(newIndex, false);
-            newInvAdjacencyMatrix[i].resize(newIndex, false);
-            for (size_t j = 0; j < newIndex; ++j) {
-                newAdjacencyMatrix[i][j] = adjacencyMatrix[getOldIndex(i, oldToNewIndex)][getOldIndex(j, oldToNewIndex)];
-                newInvAdjacencyMatrix[i][j] = invAdjacencyMatrix[getOldIndex(i, oldToNewIndex)][getOldIndex(j, oldToNewIndex)];
-            }
+    /**
+     * @brief Build the subgraph induced by #vertices in a single pass over their adjacency rows
+     * 
+     * Vertex i of the result is vertex #vertices[i] of this graph; the mapping to the original vertex names
+     * (and vertex labels, if present) are carried over.
+     * @param vertices  the vertices to keep, in the order they should appear in the subgraph
+     * @return the induced subgraph
+     */
+    template<class Vec>
+    Graph inducedSubgraph(const Vec& vertices) const {
+        size_t n = getNumVertices();
+        size_t k = vertices.size();
+        std::vector<long> oldToNew(n, -1);
+        for (size_t i = 0; i < k; ++i)
+            oldToNew[vertices[i]] = i;
+
+        Graph sub;
+        sub.wasRemapedTo0based = wasRemapedTo0based;
+        sub.adjacencyMatrix.resize(k);
+        sub.invAdjacencyMatrix.resize(k);
+        sub.degrees.resize(k);
+        sub.mapping.resize(k);
+        for (size_t i = 0; i < k; ++i) {
+            size_t old = vertices[i];
+            AdjacencyRow& row = sub.adjacencyMatrix[i];
+            row.resize(k, false);
+            adjacencyMatrix[old].forEach([&](size_t u) {
+                if (oldToNew[u] >= 0)
+                    row.set(oldToNew[u]);
+            });
+            sub.invAdjacencyMatrix[i] = row;
+            sub.invAdjacencyMatrix[i].flip();
+            sub.invAdjacencyMatrix[i].reset(i);
+            sub.degrees[i] = row.count();
+            sub.mapping[i] = mapping.empty() ? old : mapping[old];
         }
-
-        adjacencyMatrix = std::move(newAdjacencyMatrix);
-        invAdjacencyMatrix = std::move(newInvAdjacencyMatrix);
-        degrees = std::move(newDegrees);
-        mapping = std::move(newMapping);
-        labels = std::move(newLabels);
-
-        debugOut();
-    }
-
-    size_t getOldIndex(size_t newIndex, const std::vector<size_t>& oldToNewIndex) const {
-        for (size_t i = 0; i < oldToNewIndex.size(); ++i) {
-            if (oldToNewIndex[i] == newIndex) {
-                return i;
-            }
+        if (labels.vertexLabels.size() == n) {
+            sub.labels.vertexLabels.resize(k);
+            for (size_t i = 0; i < k; ++i)
+                sub.labels.vertexLabels[i] = labels.vertexLabels[vertices[i]];
         }
-        return -1;
+        return sub;
     }
 
-    std::vector<int> filterVertices(const std::vector<int>& cliqueVertices) {
-        std::vector<bool> isInClique(getNumVertices(), false);
-        for (int v : cliqueVertices) {
-            isInClique[v] = true;
-        }
-
-        std::vector<int> removedVertices;
-
-        for (int v = 0; v < getNumVertices(); ++v) { // Go over vertices to eliminate
-            bool hasValidNeighbor = false;
-            if (isInClique[v]) continue;
-            
-            for (int cliqueV = 0; cliqueV < cliqueVertices.size(); cliqueV++) { // Go over vertices in clique
-                if (areNeighbours(v,cliqueV)){
-                    hasValidNeighbor = false;
-                    break;
-                }
-                for (int u = 0; u < getNumVertices(); u++) { // Try to find connecting vertex between them
-                    if (!isInClique[u] && areNeighbours(cliqueV,u) && areNeighbours(u,v)) {
-                        hasValidNeighbor = true;
-                        break;
+    /**
+     * @brief Split the vertices into connected components (breadth-first search over the set bits of adjacency rows)
+     * @return one vector of vertices per component, each in increasing order of vertex index
+     */
+    std::vector<std::vector<VertexId> > getConnectedComponents() const {
+        size_t n = getNumVertices();
+        std::vector<std::vector<VertexId> > components;
+        BitSet unvisited(n, true);
+        for (long start = unvisited.findFirst(); start >= 0; start = unvisited.findNext(start)) {
+            std::vector<VertexId> component;
+            component.push_back(start);
+            unvisited.reset(start);
+            for (size_t i = 0; i < component.size(); ++i) {
+                adjacencyMatrix[component[i]].forEach([&](size_t u) {
+                    if (unvisited[u]) {
+                        unvisited.reset(u);
+                        component.push_back(u);
                     }
-                }
-                if (hasValidNeighbor) break;
-            }
-            if (hasValidNeighbor) {
-                removedVertices.push_back(v);
+                });
             }
+            std::sort(component.begin(), component.end());
+            components.push_back(component);
         }
-
-        
-        return removedVertices;
+        return components;
     }
 
     // Add copy constructor
@@ -719,9 +739,11 @@ public:
     }
 
     void setNeighbours(int v1, int v2, bool value) {
-        if (v1 >= 0 && v2 >= 0 && v1 < getNumVertices() && v2 < getNumVertices()) {
+        if (v1 >= 0 && v2 >= 0 && v1 < getNumVertices() && v2 < getNumVertices() && adjacencyMatrix[v1][v2] != value) {
             adjacencyMatrix[v1][v2] = value;
             adjacencyMatrix[v2][v1] = value;
+            invAdjacencyMatrix[v1][v2] = !value;
+            invAdjacencyMatrix[v2][v1] = !value;
             if (value) {
                 degrees[v1]++;
                 degrees[v2]++;
@@ -732,6 +754,122 @@ public:
         }
     }
 
+    /**
+     * @brief Greedily color the vertices of #vertices in index order, each with the smallest color none of its
+     * neighbours has, keeping the colors already set in #colors (first fit).
+     *
+     * Bit-parallel, one color class at a time as in MCS / BBMC coloring: the candidates of a class are the uncolored
+     * vertices minus the neighbours of its preset members; the first candidate joins the class and its row is removed
+     * from the candidates (AND NOT), until none is left. This takes the same vertices into each class as first fit.
+     * @param vertices  the vertices to color; edges to other vertices are ignored
+     * @param colors    input: preset colors (or -1) of the vertices in #vertices; output: their colors
+     * @return the number of colors used, 0 if #vertices is empty
+     */
+    int greedyColoring(const AdjacencyRow& vertices, std::vector<int>& colors) const {
+        static thread_local AdjacencyRow uncolored, candidates;
+        static thread_local std::vector<AdjacencyRow> presetNeighbours;  // per color: neighbours of its preset vertices
+        size_t numPresetColors = 0;
+        uncolored = vertices;
+        vertices.forEach([&](size_t v) {
+            if (colors[v] < 0) return;
+            uncolored.reset(v);
+            size_t c = colors[v];
+            if (c >= numPresetColors) {
+                if (presetNeighbours.size() <= c) presetNeighbours.resize(c + 1);
+                for (size_t d = numPresetColors; d <= c; ++d) {
+                    presetNeighbours[d].resize(getNumVertices());
+                    presetNeighbours[d].resetAll();
+                }
+                numPresetColors = c + 1;
+            }
+            presetNeighbours[c] |= adjacencyMatrix[v];
+        });
+
+        size_t color = 0;
+        for (; uncolored.any(); ++color) {
+            candidates = uncolored;
+            if (color < numPresetColors) candidates.andNot(presetNeighbours[color]);
+            for (long v = candidates.findFirst(); v != -1; v = candidates.findNext(v + 1)) {
+                colors[v] = color;
+                uncolored.reset(v);
+                candidates.andNot(adjacencyMatrix[v]);
+            }
+        }
+        return std::max(color, numPresetColors);
+    }
+
+    /**
+     * @brief Check that #colors is a proper coloring of the graph; picks the parallel or the sequential check by size,
+     * both of which return the conflict of the smallest vertex
+     * @return {-1, -1} if it is proper; {v, -1} if vertex v has no color (a negative one, or #colors is too short);
+     *         {v, u} for an edge whose ends have the same color
+     */
+    std::pair<int, int> findColoringConflict(const std::vector<int>& colors) const {
+#ifdef _OPENMP
+        if (getNumVertices() >= parallelVerificationMinNodes && omp_get_max_threads() > 1 && !omp_in_parallel())
+            return findColoringConflictParallel(colors);
+#endif
+        return findColoringConflictDense(colors);
+    }
+
+    /**
+     * @brief findColoringConflict() with a bit set per color class: a vertex conflicts iff its row intersects its own
+     * class, so the check is O(n^2 / 64) word operations
+     */
+    std::pair<int, int> findColoringConflictDense(const std::vector<int>& colors) const {
+        static thread_local std::vector<AdjacencyRow> classes;
+        int uncolored = buildColorClasses(colors, classes);
+        if (uncolored >= 0) return {uncolored, -1};
+        for (size_t v = 0; v < getNumVertices(); ++v)
+            if (adjacencyMatrix[v].intersects(classes[colors[v]]))
+                return {(int)v, firstCommon(adjacencyMatrix[v], classes[colors[v]])};
+        return {-1, -1};
+    }
+
+    /**
+     * @brief findColoringConflictDense() with the rows split among the OpenMP threads; returns the conflict of the
+     * smallest vertex, as the sequential check does
+     */
+    std::pair<int, int> findColoringConflictParallel(const std::vector<int>& colors) const {
+        static thread_local std::vector<AdjacencyRow> classes;
+        int uncolored = buildColorClasses(colors, classes);
+        if (uncolored >= 0) return {uncolored, -1};
+        const std::vector<AdjacencyRow>& cls = classes;     // the classes of this thread, not of each team member
+        long n = getNumVertices(), first = n;
+        #pragma omp parallel for schedule(static) reduction(min:first)
+        for (long v = 0; v < n; ++v)
+            if (v < first && adjacencyMatrix[v].intersects(cls[colors[v]]))
+                first = v;
+        if (first == n) return {-1, -1};
+        return {(int)first, firstCommon(adjacencyMatrix[first], cls[colors[first]])};
+    }
+
+    /**
+     * @brief Merge #v2 into #v1: v1 becomes adjacent to every neighbour of v2, and v2 is left without edges.
+     * #v1 and #v2 must be distinct and not neighbours. The rows of v1 and v2 are combined with the whole-row kernels
+     * (OR, AND NOT); only the rows of the neighbours of v2 are updated bit by bit.
+     */
+    void mergeNeighbourhoods(int v1, int v2) {
+        AdjacencyRow& row1 = adjacencyMatrix[v1];
+        AdjacencyRow& row2 = adjacencyMatrix[v2];
+        row2.forEach([&](size_t u) {
+            if (row1.test(u)) {
+                degrees[u]--;   // u loses v2 and already had v1
+            } else {
+                adjacencyMatrix[u].set(v1);
+                invAdjacencyMatrix[u].reset(v1);
+            }
+            adjacencyMatrix[u].reset(v2);
+            invAdjacencyMatrix[u].set(v2);
+        });
+        row1 |= row2;
+        invAdjacencyMatrix[v1].andNot(row2);
+        invAdjacencyMatrix[v2] |= row2;
+        row2.resetAll();
+        degrees[v1] = row1.count();
+        degrees[v2] = 0;
+    }
+
     bool areNeighbours(int v1, int v2) const {
         if (v1 >= 0 && v2 >= 0 && v1 < getNumVertices() && v2 < getNumVertices()) {
             return adjacencyMatrix[v1][v2];
@@ -739,6 +877,34 @@ public:
         return false;
     }
 
+private:
+    /**
+     * @brief Fill #classes[c] with the vertices of color c
+     * @return the first vertex without a color, -1 if all have one
+     */
+    int buildColorClasses(const std::vector<int>& colors, std::vector<AdjacencyRow>& classes) const {
+        size_t n = getNumVertices();
+        int numColors = 0;
+        for (size_t v = 0; v < n; ++v) {
+            if (v >= colors.size() || colors[v] < 0) return v;
+            numColors = std::max(numColors, colors[v] + 1);
+        }
+        if ((int)classes.size() < numColors) classes.resize(numColors);
+        for (int c = 0; c < numColors; ++c) {
+            classes[c].resize(n);
+            classes[c].resetAll();
+        }
+        for (size_t v = 0; v < n; ++v)
+            classes[colors[v]].set(v);
+        return -1;
+    }
+
+    static int firstCommon(const AdjacencyRow& a, const AdjacencyRow& b) {
+        for (long i = a.findFirst(); i != -1; i = a.findNext(i + 1))
+            if (b.test(i)) return i;
+        return -1;
+    }
+
 };
 
 
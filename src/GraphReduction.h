@@ -0,0 +1,195 @@
+#ifndef GRAPH_REDUCTION_H
+#define GRAPH_REDUCTION_H
+
+#include <vector>
+#include <algorithm>
+#include "BitSet.h"
+#include "Graph.h"
+
+/**
+ * @brief Preprocessing that shrinks a graph before the exponential search, and completes the coloring afterwards.
+ *
+ * Given a lower bound k on the chromatic number (e.g. the size of a known clique), a vertex with fewer than k
+ * neighbours can always be colored once the rest of the graph is colored with at least k colors, hence
+ * χ(G) = max(χ(G - v), k).
+ * A vertex u whose neighbourhood is contained in the neighbourhood of a non-adjacent vertex v (u is dominated by v)
+ * can always take v's color, hence χ(G) = χ(G - u).
+ * Each removal lowers the degrees of the neighbours and may enable further removals, so both rules are repeated until
+ * neither of them removes anything.
+ *
+ * All rules work on alive flags and incrementally maintained degrees of the input graph; the reduced graph is
+ * built once at the end, with #inducedSubgraph.
+ */
+template<class VectorT>
+class GraphReduction {
+public:
+    typedef typename Graph<VectorT>::VertexId VertexId;
+
+    explicit GraphReduction(const Graph<VectorT>& g) : graph(g) {}
+
+    /**
+     * @brief Apply the reduction rules until none of them removes any more vertices
+     * @param lowerBound    a known lower bound on the chromatic number of the input graph
+     * @return the reduced graph; its vertex i is vertex getKeptVertices()[i] of the input graph
+     */
+    Graph<VectorT> reduce(int lowerBound) {
+        size_t n = graph.getNumVertices();
+        this->lowerBound = lowerBound;
+        alive.clear();
+        alive.resize(n, true);
+        degree.resize(n);
+        for (size_t v = 0; v < n; ++v)
+            degree[v] = graph.adjacencyMatrix[v].count();
+        removed.clear();
+        numDominated = 0;
+
+        bool changed = true;
+        while (changed) {
+            changed = removeLowDegreeVertices();
+            changed = removeDominatedVertices() || changed;
+        }
+
+        kept.clear();
+        for (size_t v = 0; v < n; ++v)
+            if (alive[v]) kept.push_back(v);
+        return graph.inducedSubgraph(kept);
+    }
+
+    /**
+     * @brief Extend a proper coloring of the reduced graph to a proper coloring of the input graph
+     *
+     * Removed vertices are put back in the reverse order of removal, so every one of them sees exactly the
+     * neighbours it had when it was removed: a low-degree vertex sees fewer than #lowerBound colors and takes a free one,
+     * a dominated vertex takes the color of its dominator, which none of its neighbours can have.
+     * @param reducedColoring   colors of the reduced graph's vertices (0-based)
+     * @return the coloring of all vertices of the input graph
+     */
+    std::vector<int> extendColoring(const std::vector<int>& reducedColoring) const {
+        size_t n = graph.getNumVertices();
+        std::vector<int> coloring(n, -1);
+        int numColors = lowerBound;
+        for (size_t i = 0; i < kept.size(); ++i) {
+            coloring[kept[i]] = reducedColoring[i];
+            numColors = std::max(numColors, reducedColoring[i] + 1);
+        }
+
+        std::vector<char> used(numColors + 1);
+        for (size_t i = removed.size(); i-- > 0; ) {
+            VertexId v = removed[i].vertex;
+            if (removed[i].dominator >= 0) {
+                coloring[v] = coloring[removed[i].dominator];
+                continue;
+            }
+            std::fill(used.begin(), used.end(), false);
+            graph.adjacencyMatrix[v].forEach([&](size_t u) {
+                if (coloring[u] >= 0 && coloring[u] < numColors)
+                    used[coloring[u]] = true;
+            });
+            int c = 0;
+            while (used[c]) ++c;
+            coloring[v] = c;
+        }
+        return coloring;
+    }
+
+    const std::vector<VertexId>& getKeptVertices() const { return kept; }
+    size_t getNumRemoved() const { return removed.size(); }
+    size_t getNumDominated() const { return numDominated; }
+
+private:
+    /**
+     * @brief A removed vertex; dominator is the vertex whose color it takes, or -1 if it was removed for its low degree
+     */
+    struct Removal {
+        VertexId vertex;
+        VertexId dominator;
+    };
+
+    const Graph<VectorT>& graph;
+    int lowerBound = 0;
+    size_t numDominated = 0;
+    BitSet alive;
+    std::vector<int> degree;                // degree of each vertex among the alive vertices
+    std::vector<Removal> removed;           // removed vertices, in the order of removal
+    std::vector<VertexId> kept;             // kept[i] is the input vertex that became vertex i of the reduced graph
+
+    void removeVertex(VertexId v, VertexId dominator = -1) {
+        alive.reset(v);
+        removed.push_back(Removal{v, dominator});
+        if (dominator >= 0) numDominated++;
+        graph.adjacencyMatrix[v].forEach([&](size_t u) {
+            if (alive[u]) degree[u]--;
+        });
+    }
+
+    /**
+     * @brief Remove all vertices with degree below the lower bound; degrees are updated as vertices are removed,
+     * so a single pass with a work queue reaches the fixpoint of this rule
+     * @return true if any vertex was removed
+     */
+    bool removeLowDegreeVertices() {
+        size_t n = graph.getNumVertices();
+        size_t removedBefore = removed.size();
+        std::vector<VertexId> queue;
+        for (size_t v = 0; v < n; ++v)
+            if (alive[v] && degree[v] < lowerBound) queue.push_back(v);
+
+        while (!queue.empty()) {
+            VertexId v = queue.back();
+            queue.pop_back();
+            if (!alive[v]) continue;
+            removeVertex(v);
+            graph.adjacencyMatrix[v].forEach([&](size_t u) {
+                // push u just once: when its degree drops below the bound
+                if (alive[u] && degree[u] == lowerBound - 1) queue.push_back(u);
+            });
+        }
+        return removed.size() > removedBefore;
+    }
+
+    /**
+     * @brief Remove every vertex u that is dominated by a non-adjacent vertex v (N(u) ⊆ N(v)).
+     *
+     * A dominator is adjacent to every neighbour of u, so the candidates are taken from the neighbourhood of u's
+     * lowest-degree neighbour, and tried in descending order of degree; each test is a single subset test of bitset rows.
+     * @return true if any vertex was removed
+     */
+    bool removeDominatedVertices() {
+        size_t removedBefore = removed.size();
+        std::vector<VertexId> order;
+        alive.forEach([&](size_t v) { order.push_back(v); });
+        std::sort(order.begin(), order.end(), [&](VertexId a, VertexId b) { return degree[a] < degree[b]; });
+
+        BitSet neighbours, candidateSet;
+        std::vector<VertexId> candidates;
+        for (size_t i = 0; i < order.size(); ++i) {
+            VertexId u = order[i];
+            neighbours = graph.adjacencyMatrix[u];
+            neighbours &= alive;
+
+            long w = -1;
+            neighbours.forEach([&](size_t x) {
+                if (w < 0 || degree[x] < degree[w]) w = x;
+            });
+            candidateSet = (w < 0 ? alive : graph.adjacencyMatrix[w]);
+            candidateSet &= alive;
+            candidateSet.andNot(graph.adjacencyMatrix[u]);
+            candidateSet.reset(u);
+
+            candidates.clear();
+            candidateSet.forEach([&](size_t v) {
+                if (degree[v] >= degree[u]) candidates.push_back(v);
+            });
+            std::sort(candidates.begin(), candidates.end(), [&](VertexId a, VertexId b) { return degree[a] > degree[b]; });
+            for (size_t j = 0; j < candidates.size(); ++j) {
+                if (neighbours.isSubsetOf(graph.adjacencyMatrix[candidates[j]])) {
+                    removeVertex(u, candidates[j]);
+                    break;
+                }
+            }
+        }
+        return removed.size() > removedBefore;
+    }
+};
+
+#endif // GRAPH_REDUCTION_H
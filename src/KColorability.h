@@ -0,0 +1,533 @@
+#ifndef K_COLORABILITY_H
+#define K_COLORABILITY_H
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <atomic>
+#include <functional>
+#include "Graph.h"
+#include "SolverOptions.h"
+#include "SearchStats.h"
+#include "ProgressTrace.h"
+#include "VertexColoring.h"
+
+/**
+ * @brief Decides whether a graph can be colored with k colors, by conflict-driven search with clause learning.
+ *
+ * The problem is a boolean formula over the assignments "vertex v has color c": every vertex takes at least one color
+ * (a clause per vertex), at most one (pairs of assignments of one vertex) and adjacent vertices differ (pairs of
+ * assignments of one color). Only the clauses per vertex and the learned ones are stored; the pairwise constraints
+ * are propagated directly from the graph. Decisions follow DSATUR: the uncolored vertex with the fewest colors left,
+ * ties broken by how often the vertex took part in recent conflicts, then by degree, gets the color it last had if that
+ * is still possible. Every conflict is analysed down to its first unique implication point, which gives a nogood over
+ * (vertex, color) assignments that is added to the formula; the search backjumps to where the nogood propagates and
+ * restarts after a number of conflicts that follows the Luby sequence. A clique is colored up front.
+ *
+ * findChromaticNumber() asks for k = upper bound - 1, - 2, ... until a k fails, so only the last question needs a
+ * proof of infeasibility.
+ */
+template<class VectorT>
+class KColorability {
+public:
+    enum Result { colorable, notColorable, unknown };
+
+    Graph<VectorT>& graph;
+    std::vector<int> bestColoring;
+
+    KColorability(Graph<VectorT>& g, const SolverOptions& options = SolverOptions()) :
+        graph(g), options(options), lowerBound(0), upperBound(g.getNumVertices()), numConflicts(0), numDecisions(0),
+        stopRequested(false), pollInterval(1)
+    {
+        int n = g.getNumVertices();
+        neighbours.resize(n);
+        for (int v = 0; v < n; ++v)
+            for (int u = 0; u < n; ++u)
+                if (u != v && graph.adjacencyMatrix[v][u]) neighbours[v].push_back(u);
+    }
+
+    /**
+     * @brief Find the chromatic number of the graph and store the coloring in #bestColoring
+     * @param knownLowerBound   see VertexColoring::findChromaticNumber
+     * @return the number of colors used by #bestColoring; if the deadline of the options passed before the search
+     *         ended, getLowerBound() may be below it
+     */
+    int findChromaticNumber(int knownLowerBound = 0) {
+        VertexColoring<VectorT> bounds(graph, options);
+        bounds.initializeBounds(knownLowerBound);
+        bestColoring = bounds.bestColoring;
+        lowerBound = bounds.getLowerBound();
+        upperBound = bounds.getUpperBound();
+        clique.clear();
+        for (size_t i = 0; i < bounds.maxClique.size(); ++i)
+            clique.push_back(bounds.maxClique[i]);
+        trace.start("cdcl", graph.getNumVertices());
+        traceProgress(ProgressTrace::event_start);
+
+        while (lowerBound < upperBound && !stopRequested) {
+            std::vector<int> coloring;
+            int numColors = upperBound - 1;
+            Result result = decide(numColors, coloring);
+            if (options.debugOutput)
+                std::cout << "CDCL: " << numColors << " colors " << (result == colorable ? "suffice" :
+                    result == notColorable ? "do not suffice" : "undecided") << " after " << numConflicts << " conflicts" << std::endl;
+            if (result == colorable) {
+                bestColoring = coloring;
+                upperBound = std::min(upperBound, *std::max_element(coloring.begin(), coloring.end()) + 1);
+                traceProgress(ProgressTrace::event_bound);
+            } else if (result == notColorable) {
+                lowerBound = numColors + 1;
+                traceProgress(ProgressTrace::event_bound);
+            }
+            // undecided: stopped, or an imported upper bound made the question moot
+        }
+        traceProgress(ProgressTrace::event_end);
+        return upperBound;
+    }
+
+    /**
+     * @brief Decide whether the graph has a coloring with #numColors colors
+     * @param coloring  output: such a coloring, if the result is #colorable
+     * @return #unknown if the search was stopped, the deadline of the options passed or an upper bound of at most
+     *         #numColors was imported first
+     */
+    Result decide(int numColors, std::vector<int>& coloring) {
+        initialize(numColors);
+        if (clique.size() > (size_t)numColors)
+            return notColorable;
+        for (size_t i = 0; i < clique.size(); ++i)
+            assign(positive(clique[i], i), Reason{reason_none, 0});
+        if (!propagate())
+            return notColorable;
+
+        long restartCount = 0;
+        long conflictsUntilRestart = restartBase * luby(restartCount);
+        std::vector<int> learnt;
+        for (long step = 1; ; ++step) {
+            if (pollCallback && step % pollInterval == 0)
+                pollCallback();
+            if (step % deadlineCheckInterval == 0) {
+                if (options.deadlinePassed())
+                    stopRequested = true;
+                trace.poll(numDecisions, lowerBound, upperBound, -1, decisionLevel());
+            }
+            if (stopRequested || upperBound <= numColors)
+                return unknown;
+            if (!propagate()) {
+                numConflicts++;
+                if (decisionLevel() == 0)
+                    return notColorable;
+                int backjumpLevel = analyze(learnt);
+                backtrack(backjumpLevel);
+                learn(learnt);
+                decayActivities();
+                if (--conflictsUntilRestart == 0) {
+                    conflictsUntilRestart = restartBase * luby(++restartCount);
+                    backtrack(0);
+                    if (clauses.size() >= maxLearnts) reduceLearnts();
+                }
+                continue;
+            }
+
+            int v = selectVertex();
+            if (v < 0) {
+                coloring = trueColor;
+                return colorable;
+            }
+            numDecisions++;
+            SearchStats::count(SearchStats::nodes_expanded);
+            trailLimits.push_back(trail.size());
+            assign(positive(v, selectColor(v)), Reason{reason_none, 0});
+        }
+    }
+
+    int getLowerBound() const { return lowerBound; }
+    int getUpperBound() const { return upperBound; }
+    long getNumConflicts() const { return numConflicts; }
+    long getNumDecisions() const { return numDecisions; }
+    long getNumNodes() const { return numDecisions; }     // a decision opens a node of the search tree
+
+    /**
+     * @brief Lower the upper bound to #bound, found elsewhere; to be called from the poll callback.
+     * #bestColoring only gets replaced by colorings with fewer colors than that.
+     */
+    void importUpperBound(int bound) {
+        if (bound >= upperBound) return;
+        upperBound = bound;
+        traceProgress(ProgressTrace::event_bound);
+    }
+
+    /**
+     * @brief Make the search return as soon as possible; #bestColoring keeps the best coloring found so far
+     */
+    void requestStop() { stopRequested = true; }
+    bool isStopRequested() const { return stopRequested.load(); }
+
+    /**
+     * @brief Call #callback after every #interval propagation rounds (a decision or a conflict each)
+     */
+    void setPollCallback(long interval, std::function<void()> callback) {
+        pollInterval = interval;
+        pollCallback = callback;
+    }
+
+private:
+    // why an assignment was made; the clause it was propagated from can be rebuilt from this
+    enum ReasonType {
+        reason_none,        // a decision, or an assignment made up front
+        reason_pair,        // false because the assignment #data (of the same vertex or a neighbour, same color) is true
+        reason_vertex,      // true because every other color of vertex #data is false
+        reason_clause       // propagated from the learned clause #data
+    };
+    struct Reason {
+        ReasonType type;
+        int data;
+    };
+    struct Clause {
+        std::vector<int> literals;  // the first two are watched
+        int levels;                 // number of distinct decision levels when it was learned (LBD)
+    };
+
+    static const int restartBase = 100;
+    static const long deadlineCheckInterval = 1024;
+
+    SolverOptions options;
+    std::vector<std::vector<int> > neighbours;
+    std::vector<int> clique;
+    int lowerBound;
+    int upperBound;
+    long numConflicts;
+    long numDecisions;
+    std::atomic<bool> stopRequested;
+    long pollInterval;
+    std::function<void()> pollCallback;
+    ProgressTrace::Source trace;
+
+    // state of decide(): variable v * k + c is "v has color c", literal 2 * variable (+ 1 if negated)
+    int k;
+    std::vector<signed char> value;     // per variable: -1 unassigned, 0 false, 1 true
+    std::vector<int> level;
+    std::vector<Reason> reason;
+    std::vector<int> trail;             // true literals in assignment order
+    std::vector<int> trailLimits;       // per decision level: trail size before its decision
+    size_t propagated;                  // trail literals whose consequences have been propagated
+    std::vector<int> trueColor;         // per vertex: its color, -1 if none yet
+    std::vector<int> colorsLeft;        // per vertex: colors not assigned false
+    std::vector<int> savedColor;        // per vertex: color of the last assignment, preferred by the next decision
+    std::vector<double> activity;       // per vertex: bumped when it takes part in a conflict
+    double activityIncrement;
+    std::vector<Clause> clauses;
+    std::vector<std::vector<int> > watches;     // per literal: clauses watching it
+    size_t maxLearnts;
+    std::vector<int> conflict;          // literals of the clause falsified by the last conflict
+    std::vector<char> seen;
+    std::vector<int> reasonLiterals;
+
+    int positive(int v, int c) const { return 2 * (v * k + c); }
+    int decisionLevel() const { return trailLimits.size(); }
+
+    void traceProgress(ProgressTrace::Event event) {
+        trace.record(event, numDecisions, lowerBound, upperBound);
+    }
+
+    // 1 true, 0 false, -1 unassigned
+    int literalValue(int literal) const {
+        int x = value[literal >> 1];
+        return x < 0 ? -1 : x ^ (literal & 1);
+    }
+
+    void initialize(int numColors) {
+        k = numColors;
+        int n = graph.getNumVertices();
+        size_t numVariables = (size_t)n * k;
+        value.assign(numVariables, -1);
+        level.assign(numVariables, 0);
+        reason.assign(numVariables, Reason{reason_none, 0});
+        seen.assign(numVariables, 0);
+        trail.clear();
+        trailLimits.clear();
+        propagated = 0;
+        trueColor.assign(n, -1);
+        colorsLeft.assign(n, k);
+        savedColor.assign(n, 0);
+        activity.assign(n, 0.0);
+        activityIncrement = 1.0;
+        clauses.clear();
+        watches.assign(2 * numVariables, std::vector<int>());
+        maxLearnts = std::max<size_t>(2000, numVariables / 2);
+    }
+
+    /**
+     * @brief Make #literal true
+     * @return false if it is already false
+     */
+    bool assign(int literal, Reason why) {
+        int x = literal >> 1;
+        if (value[x] >= 0)
+            return literalValue(literal) == 1;
+        value[x] = !(literal & 1);
+        level[x] = decisionLevel();
+        reason[x] = why;
+        trail.push_back(literal);
+        int v = x / k;
+        if (literal & 1)
+            colorsLeft[v]--;
+        else
+            trueColor[v] = x % k;
+        return true;
+    }
+
+    /**
+     * @brief Undo all assignments above #targetLevel
+     */
+    void backtrack(int targetLevel) {
+        if (decisionLevel() <= targetLevel) return;
+        for (size_t i = trail.size(); i-- > (size_t)trailLimits[targetLevel]; ) {
+            int x = trail[i] >> 1;
+            int v = x / k;
+            if (trail[i] & 1) {
+                colorsLeft[v]++;
+            } else {
+                trueColor[v] = -1;
+                savedColor[v] = x % k;
+            }
+            value[x] = -1;
+        }
+        trail.resize(trailLimits[targetLevel]);
+        trailLimits.resize(targetLevel);
+        propagated = trail.size();
+    }
+
+    /**
+     * @brief The clause #literal was propagated from (#literal included), or the one a failed assign() falsified
+     */
+    void clauseOf(int literal, const Reason& why, std::vector<int>& out) const {
+        out.clear();
+        switch (why.type) {
+        case reason_pair:
+            out.push_back(literal);
+            out.push_back(2 * why.data + 1);
+            break;
+        case reason_vertex:
+            for (int c = 0; c < k; ++c)
+                out.push_back(positive(why.data, c));
+            break;
+        case reason_clause:
+            out = clauses[why.data].literals;
+            break;
+        default:
+            break;
+        }
+    }
+
+    bool fail(int literal, Reason why) {
+        clauseOf(literal, why, conflict);
+        return false;
+    }
+
+    /**
+     * @brief Propagate all pending assignments
+     * @return false on a conflict, whose clause is left in #conflict
+     */
+    bool propagate() {
+        while (propagated < trail.size()) {
+            int literal = trail[propagated++];
+            int x = literal >> 1;
+            int v = x / k, c = x % k;
+            if (!(literal & 1)) {
+                // v has color c: no other color for v, and no neighbour has c
+                Reason why{reason_pair, x};
+                for (int other = 0; other < k; ++other)
+                    if (other != c && !assign(positive(v, other) + 1, why)) return fail(positive(v, other) + 1, why);
+                for (size_t i = 0; i < neighbours[v].size(); ++i) {
+                    int u = neighbours[v][i];
+                    if (!assign(positive(u, c) + 1, why)) return fail(positive(u, c) + 1, why);
+                }
+            } else if (trueColor[v] < 0) {
+                // v loses a color: it needs at least one
+                if (colorsLeft[v] == 0) return fail(positive(v, 0), Reason{reason_vertex, v});
+                if (colorsLeft[v] == 1) {
+                    int last = 0;
+                    while (value[v * k + last] == 0) ++last;
+                    assign(positive(v, last), Reason{reason_vertex, v});
+                }
+            }
+            if (!propagateClauses(literal ^ 1)) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Visit the learned clauses watching #falseLiteral: move the watch, propagate or report a conflict
+     */
+    bool propagateClauses(int falseLiteral) {
+        std::vector<int>& watching = watches[falseLiteral];
+        size_t kept = 0;
+        bool ok = true;
+        for (size_t i = 0; i < watching.size(); ++i) {
+            int index = watching[i];
+            if (!ok) {
+                watching[kept++] = index;
+                continue;
+            }
+            std::vector<int>& literals = clauses[index].literals;
+            if (literals[0] == falseLiteral) std::swap(literals[0], literals[1]);
+            if (literalValue(literals[0]) == 1) {
+                watching[kept++] = index;
+                continue;
+            }
+            bool moved = false;
+            for (size_t j = 2; j < literals.size(); ++j) {
+                if (literalValue(literals[j]) != 0) {
+                    std::swap(literals[1], literals[j]);
+                    watches[literals[1]].push_back(index);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+            watching[kept++] = index;
+            if (!assign(literals[0], Reason{reason_clause, index}))
+                ok = fail(literals[0], Reason{reason_clause, index});
+        }
+        watching.resize(kept);
+        return ok;
+    }
+
+    /**
+     * @brief First-UIP analysis of #conflict
+     * @param learnt    output: the learned clause; its first literal is the one it propagates after the backjump
+     * @return the decision level to backjump to
+     */
+    int analyze(std::vector<int>& learnt) {
+        learnt.assign(1, -1);
+        int pending = 0;
+        int literal = -1;
+        size_t index = trail.size();
+        const std::vector<int>* clause = &conflict;
+        while (true) {
+            for (size_t i = 0; i < clause->size(); ++i) {
+                int x = (*clause)[i] >> 1;
+                if (literal >= 0 && x == (literal >> 1)) continue;
+                if (seen[x] || level[x] == 0) continue;
+                seen[x] = 1;
+                bumpActivity(x / k);
+                if (level[x] == decisionLevel())
+                    pending++;
+                else
+                    learnt.push_back((*clause)[i]);
+            }
+            while (!seen[trail[--index] >> 1]) {}
+            literal = trail[index];
+            seen[literal >> 1] = 0;
+            if (--pending == 0) break;
+            clauseOf(literal, reason[literal >> 1], reasonLiterals);
+            clause = &reasonLiterals;
+        }
+        learnt[0] = literal ^ 1;
+
+        // the highest level below the conflict level goes second, it is watched and decides the backjump
+        int backjumpLevel = 0;
+        for (size_t i = 1; i < learnt.size(); ++i) {
+            seen[learnt[i] >> 1] = 0;
+            if (level[learnt[i] >> 1] > backjumpLevel) {
+                backjumpLevel = level[learnt[i] >> 1];
+                std::swap(learnt[1], learnt[i]);
+            }
+        }
+        return backjumpLevel;
+    }
+
+    void learn(const std::vector<int>& learnt) {
+        if (learnt.size() == 1) {
+            assign(learnt[0], Reason{reason_none, 0});
+            return;
+        }
+        std::vector<int> levels;
+        for (size_t i = 0; i < learnt.size(); ++i)
+            levels.push_back(level[learnt[i] >> 1]);
+        std::sort(levels.begin(), levels.end());
+        Clause clause{learnt, (int)(std::unique(levels.begin(), levels.end()) - levels.begin())};
+        int index = clauses.size();
+        clauses.push_back(clause);
+        watches[learnt[0]].push_back(index);
+        watches[learnt[1]].push_back(index);
+        assign(learnt[0], Reason{reason_clause, index});
+    }
+
+    /**
+     * @brief Keep the learned clauses with few distinct levels, the better half and all of those over at most two
+     * levels; called at level 0, where no assignment has a clause as its reason that analysis could still ask for
+     */
+    void reduceLearnts() {
+        std::vector<int> order(clauses.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return clauses[a].levels < clauses[b].levels; });
+        std::vector<Clause> kept;
+        for (size_t i = 0; i < order.size(); ++i) {
+            const Clause& clause = clauses[order[i]];
+            if (i < order.size() / 2 || clause.levels <= 2)
+                kept.push_back(clause);
+        }
+        clauses.swap(kept);
+        for (size_t l = 0; l < watches.size(); ++l)
+            watches[l].clear();
+        for (size_t i = 0; i < clauses.size(); ++i) {
+            watches[clauses[i].literals[0]].push_back(i);
+            watches[clauses[i].literals[1]].push_back(i);
+        }
+        maxLearnts += maxLearnts / 10;
+    }
+
+    void bumpActivity(int v) {
+        activity[v] += activityIncrement;
+        if (activity[v] > 1e100) {
+            for (size_t u = 0; u < activity.size(); ++u) activity[u] *= 1e-100;
+            activityIncrement *= 1e-100;
+        }
+    }
+
+    void decayActivities() { activityIncrement /= 0.95; }
+
+    /**
+     * @brief DSATUR order: the uncolored vertex with the fewest colors left, then the most active, then the highest degree
+     * @return -1 if all vertices are colored
+     */
+    int selectVertex() const {
+        int best = -1;
+        for (size_t v = 0; v < trueColor.size(); ++v) {
+            if (trueColor[v] >= 0) continue;
+            if (best < 0 || colorsLeft[v] < colorsLeft[best]
+                || (colorsLeft[v] == colorsLeft[best] && (activity[v] > activity[best]
+                    || (activity[v] == activity[best] && neighbours[v].size() > neighbours[best].size()))))
+                best = v;
+        }
+        return best;
+    }
+
+    int selectColor(int v) const {
+        if (value[v * k + savedColor[v]] < 0) return savedColor[v];
+        int c = 0;
+        while (value[v * k + c] >= 0) ++c;
+        return c;
+    }
+
+    /**
+     * @brief The Luby sequence 1 1 2 1 1 2 4 1 1 2 ... at position #i
+     */
+    static long luby(long i) {
+        long size = 1, power = 1;
+        while (size < i + 1) {
+            size = 2 * size + 1;
+            power *= 2;
+        }
+        while (size - 1 != i) {
+            size = (size - 1) / 2;
+            power /= 2;
+            i %= size;
+        }
+        return power;
+    }
+};
+
+#endif // K_COLORABILITY_H
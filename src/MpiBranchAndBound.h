@@ -0,0 +1,339 @@
+#ifndef MPI_BRANCH_AND_BOUND_H
+#define MPI_BRANCH_AND_BOUND_H
+
+#include <mpi.h>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <thread>
+#include "Graph.h"
+#include "SolverOptions.h"
+#include "VertexColoring.h"
+
+/**
+ * @brief Zykov branch and bound distributed over the ranks of an MPI communicator.
+ *
+ * Every rank holds the same graph. Rank 0 expands the top of the search tree breadth-first until there are a few open
+ * nodes per worker, and then hands them out one at a time to workers that ask for work. An open node is sent as the list
+ * of branching decisions (merge or add edge) leading to it from the root, and the worker replays them on its own copy
+ * of the graph; each worker searches its subtrees with the iterative engine.
+ *
+ * Upper bounds are exchanged through a chain of non-blocking all-reductions: each rank contributes its best upper bound
+ * and starts the next reduction as soon as the previous one completes, workers progress it every #pollInterval nodes.
+ * The same reductions carry termination: once the bounds meet, or no open nodes are left and every worker is waiting
+ * for work, rank 0 contributes a "done" flag, and all ranks leave the search after that same reduction.
+ * Only rank 0 watches the deadline of the options: when it passes, rank 0 ends the search the same way, and the
+ * lower bound stays the one of the root.
+ * Finally the rank holding the best coloring broadcasts it to all others.
+ */
+template<class VectorT>
+class MpiBranchAndBound {
+public:
+    typedef typename VertexColoring<VectorT>::Node Node;
+
+    MpiBranchAndBound(Graph<VectorT>& g, const SolverOptions& options, MPI_Comm comm = MPI_COMM_WORLD) :
+        solver(g, withoutDeadline(options)), options(options), comm(comm), numColors(0), lowerBound(0), numNodes(0),
+        complete(true)
+    {
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &numRanks);
+    }
+
+    /**
+     * @brief Find the chromatic number; must be called by all ranks of the communicator, with the same graph
+     * @param knownLowerBound   see VertexColoring::findChromaticNumber
+     * @return the number of colors used by getColoring(), the same on all ranks; if the deadline passed, getLowerBound()
+     *         may be below it
+     */
+    int solve(int knownLowerBound) {
+        // the root bounds are deterministic, so all ranks agree on whether a search is needed
+        bool solvedAtRoot = solver.initializeBounds(knownLowerBound);
+        // every rank traces its own part of the search (main gives each rank its own file)
+        solver.startTrace(("zykov, MPI rank " + std::to_string(rank)).c_str());
+        if (!solvedAtRoot && numRanks > 1) {
+            BoundExchange exchange(comm);
+            exchange.start(solver.getUpperBound(), false);
+            if (rank == 0)
+                coordinate(exchange);
+            else
+                work(exchange);
+            drainMessages();
+            int completed = complete;
+            MPI_Bcast(&completed, 1, MPI_INT, 0, comm);
+            complete = completed;
+        }
+        solver.traceProgress(ProgressTrace::event_end);
+        gatherBestColoring();
+        long localNodes = solver.getNumNodes();
+        MPI_Allreduce(&localNodes, &numNodes, 1, MPI_LONG, MPI_SUM, comm);
+        lowerBound = complete ? numColors : std::max(solver.getLowerBound(), knownLowerBound);
+        return numColors;
+    }
+
+    const std::vector<int>& getColoring() const { return coloring; }
+    int getLowerBound() const { return lowerBound; }
+    long getNumNodes() const { return numNodes; }     // of all ranks together
+
+private:
+    enum Tag { tag_request = 1, tag_work = 2 };
+    enum Decision { decision_merge = 0, decision_addEdge = 1 };
+
+    static const int initialNodesPerWorker = 4;
+    static const long pollInterval = 32;
+
+    /**
+     * @brief One all-reduction (MIN) in flight at a time, carrying the upper bound and the termination flag
+     */
+    class BoundExchange {
+    public:
+        explicit BoundExchange(MPI_Comm comm) : comm(comm), upperBound(std::numeric_limits<int>::max()), finished(false) {}
+
+        void start(int localUpperBound, bool done) {
+            local[0] = localUpperBound;
+            local[1] = done ? -1 : 0;
+            MPI_Iallreduce(local, global, 2, MPI_INT, MPI_MIN, comm, &request);
+        }
+
+        /**
+         * @brief Complete the pending reduction if possible and start the next one with the given contribution
+         * @return true once a reduction with the "done" flag has completed
+         */
+        bool progress(int localUpperBound, bool done) {
+            if (finished) return true;
+            int completed = 0;
+            MPI_Test(&request, &completed, MPI_STATUS_IGNORE);
+            if (completed) {
+                upperBound = global[0];
+                if (global[1] < 0)
+                    finished = true;
+                else
+                    start(localUpperBound, done);
+            }
+            return finished;
+        }
+
+        bool isFinished() const { return finished; }
+        int getUpperBound() const { return upperBound; }
+
+    private:
+        MPI_Comm comm;
+        MPI_Request request;
+        int local[2];
+        int global[2];
+        int upperBound;     // result of the last completed reduction
+        bool finished;
+    };
+
+    VertexColoring<VectorT> solver;
+    SolverOptions options;
+    MPI_Comm comm;
+    int rank, numRanks;
+    std::vector<int> coloring;
+    int numColors;
+    int lowerBound;
+    long numNodes;
+    bool complete;                      // false if rank 0 ended the search at the deadline
+    std::vector<int> messagesSent;      // per rank: work messages sent (rank 0) or work requests sent (workers)
+    std::vector<int> messagesReceived;  // per rank: work requests received (rank 0) or work messages received (workers)
+
+    static void idleWait() { std::this_thread::sleep_for(std::chrono::microseconds(50)); }
+
+    /**
+     * @brief The options of the local searches: a worker that stopped at its own deadline would report its subtree
+     * as searched, so the deadline is left to rank 0
+     */
+    static SolverOptions withoutDeadline(SolverOptions options) {
+        options.setTimeLimit(0);
+        return options;
+    }
+
+    /**
+     * @brief Expand the tree breadth-first from the root until there are enough open nodes for the workers
+     * @return the open nodes, as decision paths: triples (decision, v1, v2)
+     */
+    std::deque<std::vector<int> > expandFrontier() {
+        size_t target = (size_t)initialNodesPerWorker * (numRanks - 1);
+        std::deque<std::pair<Node, std::vector<int> > > open;
+        open.push_back(std::make_pair(Node(solver.graph), std::vector<int>()));
+
+        while (!open.empty() && open.size() < target) {
+            Node node = open.front().first;
+            std::vector<int> path = open.front().second;
+            open.pop_front();
+            if (node.numActiveVertices <= 1 || solver.getLowerBound() >= solver.getUpperBound()) continue;
+
+            std::pair<int, int> vertices = solver.evaluateNode(node, open.size());
+            if (vertices.first == -1 || vertices.second == -1) continue;
+
+            Node edgeNode(node);
+            solver.addEdgeInPlace(edgeNode, vertices.first, vertices.second);
+            std::vector<int> edgePath(path);
+            edgePath.push_back(decision_addEdge);
+            edgePath.push_back(vertices.first);
+            edgePath.push_back(vertices.second);
+
+            solver.mergeVerticesInPlace(node, vertices.first, vertices.second);
+            path.push_back(decision_merge);
+            path.push_back(vertices.first);
+            path.push_back(vertices.second);
+
+            open.push_back(std::make_pair(node, path));
+            open.push_back(std::make_pair(edgeNode, edgePath));
+        }
+
+        std::deque<std::vector<int> > frontier;
+        for (size_t i = 0; i < open.size(); ++i)
+            frontier.push_back(open[i].second);
+        return frontier;
+    }
+
+    /**
+     * @brief Rank 0: hand out the open nodes on request and decide when the search is over
+     */
+    void coordinate(BoundExchange& exchange) {
+        messagesSent.assign(numRanks, 0);
+        messagesReceived.assign(numRanks, 0);
+        std::deque<std::vector<int> > frontier = expandFrontier();
+        std::vector<int> waiting;
+
+        while (!exchange.isFinished()) {
+            bool busy = false;
+            int hasRequest = 0;
+            MPI_Status status;
+            MPI_Iprobe(MPI_ANY_SOURCE, tag_request, comm, &hasRequest, &status);
+            if (hasRequest) {
+                MPI_Recv(nullptr, 0, MPI_INT, status.MPI_SOURCE, tag_request, comm, MPI_STATUS_IGNORE);
+                messagesReceived[status.MPI_SOURCE]++;
+                waiting.push_back(status.MPI_SOURCE);
+                busy = true;
+            }
+
+            bool boundsMet = solver.getLowerBound() >= solver.getUpperBound();
+            while (!waiting.empty() && !frontier.empty() && !boundsMet) {
+                std::vector<int>& path = frontier.front();
+                MPI_Send(path.data(), path.size(), MPI_INT, waiting.back(), tag_work, comm);
+                messagesSent[waiting.back()]++;
+                waiting.pop_back();
+                frontier.pop_front();
+            }
+
+            bool searched = boundsMet || (frontier.empty() && (int)waiting.size() == numRanks - 1);
+            if (!searched && options.deadlinePassed())
+                complete = false;
+            bool done = searched || !complete;
+            exchange.progress(solver.getUpperBound(), done);
+            solver.importUpperBound(exchange.getUpperBound());
+            if (!busy) idleWait();
+        }
+    }
+
+    /**
+     * @brief Worker ranks: ask for an open node, search its subtree, repeat until rank 0 ends the search
+     */
+    void work(BoundExchange& exchange) {
+        messagesSent.assign(1, 0);
+        messagesReceived.assign(1, 0);
+        solver.setPollCallback(pollInterval, [&]() {
+            if (exchange.progress(solver.getUpperBound(), false))
+                solver.requestStop();
+            solver.importUpperBound(exchange.getUpperBound());
+        });
+
+        bool requested = false;
+        while (!exchange.isFinished()) {
+            if (!requested) {
+                MPI_Send(nullptr, 0, MPI_INT, 0, tag_request, comm);
+                messagesSent[0]++;
+                requested = true;
+            }
+
+            int hasWork = 0;
+            MPI_Status status;
+            MPI_Iprobe(0, tag_work, comm, &hasWork, &status);
+            if (hasWork) {
+                std::vector<int> path = receivePath(status);
+                requested = false;
+                Node node = replay(path);
+                solver.branchAndBoundIterative(node);
+                continue;
+            }
+
+            exchange.progress(solver.getUpperBound(), false);
+            solver.importUpperBound(exchange.getUpperBound());
+            idleWait();
+        }
+    }
+
+    std::vector<int> receivePath(const MPI_Status& status) {
+        int length = 0;
+        MPI_Get_count(&status, MPI_INT, &length);
+        std::vector<int> path(length);
+        MPI_Recv(path.data(), length, MPI_INT, 0, tag_work, comm, MPI_STATUS_IGNORE);
+        messagesReceived[0]++;
+        return path;
+    }
+
+    /**
+     * @brief Rebuild an open node from the root by applying its branching decisions
+     */
+    Node replay(const std::vector<int>& path) const {
+        Node node(solver.graph);
+        for (size_t i = 0; i + 2 < path.size(); i += 3) {
+            if (path[i] == decision_merge)
+                solver.mergeVerticesInPlace(node, path[i + 1], path[i + 2]);
+            else
+                solver.addEdgeInPlace(node, path[i + 1], path[i + 2]);
+        }
+        return node;
+    }
+
+    /**
+     * @brief Receive the messages that were still in flight when the search ended: requests of workers that finished
+     * a subtree, and open nodes sent to workers that had already left the search
+     */
+    void drainMessages() {
+        std::vector<int> sent(numRanks, 0);
+        int mySent = (rank == 0 ? 0 : messagesSent[0]);
+        MPI_Gather(&mySent, 1, MPI_INT, sent.data(), 1, MPI_INT, 0, comm);
+        int workSent = 0;
+        MPI_Scatter(rank == 0 ? messagesSent.data() : nullptr, 1, MPI_INT, &workSent, 1, MPI_INT, 0, comm);
+
+        if (rank == 0) {
+            for (int r = 1; r < numRanks; ++r)
+                for (int i = messagesReceived[r]; i < sent[r]; ++i)
+                    MPI_Recv(nullptr, 0, MPI_INT, r, tag_request, comm, MPI_STATUS_IGNORE);
+        } else {
+            for (int i = messagesReceived[0]; i < workSent; ++i) {
+                MPI_Status status;
+                MPI_Probe(0, tag_work, comm, &status);
+                receivePath(status);
+            }
+        }
+    }
+
+    /**
+     * @brief Find the rank with the coloring that uses the fewest colors and broadcast it
+     */
+    void gatherBestColoring() {
+        const std::vector<int>& local = solver.bestColoring;
+        int localColors = local.empty() ? 0 : *std::max_element(local.begin(), local.end()) + 1;
+        if (numRanks == 1) {
+            coloring = local;
+            numColors = localColors;
+            return;
+        }
+
+        int in[2] = {localColors, rank};
+        int out[2];
+        MPI_Allreduce(in, out, 1, MPI_2INT, MPI_MINLOC, comm);
+        numColors = out[0];
+        coloring = local;
+        coloring.resize(solver.graph.getNumVertices());
+        MPI_Bcast(coloring.data(), coloring.size(), MPI_INT, out[1], comm);
+    }
+};
+
+#endif // MPI_BRANCH_AND_BOUND_H
@@ -0,0 +1,97 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @brief A slab of reusable search nodes.
+ *
+ * Nodes are never destroyed while the pool lives: a released node goes on a free list, and acquiring a node
+ * copy-assigns into a free one, so the vectors it owns keep their capacity and, once the pool is warm, expanding a
+ * node allocates nothing.
+ * The slab is also a stack: mark() remembers its top, and releaseTo() gives back every node acquired since, in O(1)
+ * regardless of how many there are, which releases a whole searched or pruned subtree at once. While a mark is open,
+ * acquire() does not reuse the nodes that were free when it was taken, so releaseTo() finds them where they were.
+ * Marks must be released in last-in first-out order, and nodes acquired before a mark must not be released between it
+ * and its releaseTo().
+ *
+ * @tparam T the node type; must be copy-constructible and copy-assignable
+ */
+template<class T>
+class NodePool {
+public:
+    /**
+     * @brief The state of the pool at one point, to return to with releaseTo()
+     */
+    struct Mark {
+        size_t top;
+        size_t numFree;
+        size_t reservedFree;    // of the enclosing mark
+    };
+
+    NodePool() : top(0), reservedFree(0) {}
+
+    /**
+     * @brief Create a pool with #initialSize nodes preallocated as copies of #prototype
+     */
+    NodePool(size_t initialSize, const T& prototype) : top(0), reservedFree(0) {
+        storage.reserve(initialSize);
+        for (size_t i = 0; i < initialSize; ++i)
+            storage.emplace_back(new T(prototype));
+    }
+
+    /**
+     * @brief Get a node that is a copy of #source
+     */
+    T* acquire(const T& source) {
+        T* node;
+        if (freeList.size() > reservedFree) {
+            node = freeList.back();
+            freeList.pop_back();
+        } else if (top < storage.size()) {
+            node = storage[top++].get();
+        } else {
+            storage.emplace_back(new T(source));
+            top++;
+            return storage.back().get();
+        }
+        *node = source;
+        return node;
+    }
+
+    /**
+     * @brief Return #node to the pool; its buffers are reused by a later acquire
+     */
+    void release(T* node) {
+        freeList.push_back(node);
+    }
+
+    Mark mark() {
+        Mark m{top, freeList.size(), reservedFree};
+        reservedFree = freeList.size();
+        return m;
+    }
+
+    /**
+     * @brief Release every node acquired since #m was taken; the nodes on the free list above its entries all come
+     * from the slab above its top, so they are given back with it
+     */
+    void releaseTo(const Mark& m) {
+        top = m.top;
+        freeList.resize(m.numFree);
+        reservedFree = m.reservedFree;
+    }
+
+    size_t size() const { return storage.size(); }
+    size_t numInUse() const { return top - freeList.size(); }
+
+private:
+    std::vector<std::unique_ptr<T> > storage;   // storage[0 .. top) are acquired or on the free list
+    size_t top;
+    std::vector<T*> freeList;
+    size_t reservedFree;    // the first entries of the free list, which belong to the innermost open mark
+};
+
+#endif // NODE_POOL_H
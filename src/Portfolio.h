@@ -0,0 +1,134 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <iostream>
+#include <omp.h>
+#include "Graph.h"
+#include "SolverOptions.h"
+#include "Blackboard.h"
+#include "VertexColoring.h"
+#include "DsaturColoring.h"
+#include "KColorability.h"
+
+/**
+ * @brief Runs the exact engines side by side on the same graph and keeps the first answer.
+ *
+ * The engines share the OpenMP thread budget T (omp_get_max_threads()): DSATUR and the k-colorability search get one
+ * thread each, including for the parallel parts of their bounds, and Zykov branch and bound gets the rest. Below three
+ * threads engines are left out rather than oversubscribing the cores: with T = 2 Zykov and the k-colorability search
+ * run, with T = 1 Zykov alone. Every engine publishes its upper bound on a shared Blackboard and prunes with the best
+ * one published, and an engine that ends publishes the lower bound it proved. As soon as the bounds meet, the cancellation token stops the others.
+ * The result is the coloring with the fewest colors among those of all engines.
+ */
+template<class VectorT>
+class Portfolio {
+public:
+    Graph<VectorT>& graph;
+    std::vector<int> bestColoring;
+
+    Portfolio(Graph<VectorT>& g, const SolverOptions& options = SolverOptions()) :
+        graph(g), options(options), lowerBound(0), upperBound(g.getNumVertices()), numNodes(0) {}
+
+    /**
+     * @brief Find the chromatic number of the graph and store the coloring in #bestColoring
+     * @param knownLowerBound   see VertexColoring::findChromaticNumber
+     * @return the number of colors used by #bestColoring; if the deadline of the options passed before an engine
+     *         ended, getLowerBound() may be below it
+     */
+    int findChromaticNumber(int knownLowerBound = 0) {
+        CancellationToken token;
+        Blackboard board(token, knownLowerBound);
+
+        int budget = std::max(1, omp_get_max_threads());
+        bool runCdcl = budget >= 2, runDsatur = budget >= 3;
+        int zykovThreads = budget - runCdcl - runDsatur;
+        if (options.debugOutput && !runDsatur)
+            std::cout << "Portfolio: " << budget << " thread(s), running zykov" << (runCdcl ? " and cdcl" : "")
+                << " only" << std::endl;
+        SolverOptions zykovOptions(options);
+        if (zykovThreads == 1 && zykovOptions.searchMode == SolverOptions::search_tasks)
+            zykovOptions.searchMode = SolverOptions::search_iterative;
+        VertexColoring<VectorT> zykov(graph, zykovOptions);
+        DsaturColoring<VectorT> dsatur(graph, options);
+        KColorability<VectorT> cdcl(graph, options);
+
+        std::thread zykovThread([&]() {
+            omp_set_num_threads(zykovThreads);
+            run(zykov, "zykov", board, token, knownLowerBound);
+        });
+        std::thread dsaturThread, cdclThread;
+        if (runDsatur) {
+            dsaturThread = std::thread([&]() {
+                omp_set_num_threads(1);
+                run(dsatur, "dsatur", board, token, knownLowerBound);
+            });
+        }
+        if (runCdcl) {
+            cdclThread = std::thread([&]() {
+                omp_set_num_threads(1);
+                run(cdcl, "cdcl", board, token, knownLowerBound);
+            });
+        }
+        zykovThread.join();
+        if (dsaturThread.joinable()) dsaturThread.join();
+        if (cdclThread.joinable()) cdclThread.join();
+
+        bestColoring = zykov.bestColoring;
+        keepBetter(dsatur.bestColoring);
+        keepBetter(cdcl.bestColoring);
+        upperBound = numColors(bestColoring);
+        lowerBound = std::min(board.getLowerBound(), upperBound);
+        numNodes = zykov.getNumNodes() + dsatur.getNumNodes() + cdcl.getNumNodes();
+        return upperBound;
+    }
+
+    int getLowerBound() const { return lowerBound; }
+    int getUpperBound() const { return upperBound; }
+    long getNumNodes() const { return numNodes; }     // of all engines together
+
+private:
+    static const long pollInterval = 64;
+
+    SolverOptions options;
+    int lowerBound;
+    int upperBound;
+    long numNodes;
+
+    /**
+     * @brief Run one engine, connected to the blackboard and the cancellation token through its poll callback
+     */
+    template<class Solver>
+    void run(Solver& solver, const char* name, Blackboard& board, CancellationToken& token, int knownLowerBound) {
+        try {
+            // the engine's own upper bound is never below the published one unless it found that coloring itself
+            solver.setPollCallback(pollInterval, [&]() {
+                board.offerUpperBound(solver.getUpperBound());
+                solver.importUpperBound(board.getUpperBound());
+                if (token.isCancelled()) solver.requestStop();
+            });
+            solver.findChromaticNumber(std::max(knownLowerBound, board.getLowerBound()));
+            if (!solver.bestColoring.empty())
+                board.offerUpperBound(numColors(solver.bestColoring));
+            board.raiseLowerBound(solver.getLowerBound());
+            if (options.debugOutput)
+                std::cout << "Portfolio: " << name << " ended with bounds " << solver.getLowerBound() << " .. "
+                    << numColors(solver.bestColoring) << (solver.isStopRequested() ? " (stopped)" : "") << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "Error in Portfolio (" << name << "): " << e.what() << std::endl;
+        }
+    }
+
+    void keepBetter(const std::vector<int>& coloring) {
+        if (!coloring.empty() && (bestColoring.empty() || numColors(coloring) < numColors(bestColoring)))
+            bestColoring = coloring;
+    }
+
+    static int numColors(const std::vector<int>& coloring) {
+        return coloring.empty() ? 0 : *std::max_element(coloring.begin(), coloring.end()) + 1;
+    }
+};
+
+#endif // PORTFOLIO_H
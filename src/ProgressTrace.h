@@ -0,0 +1,138 @@
+#ifndef PROGRESS_TRACE_H
+#define PROGRESS_TRACE_H
+
+#include <cstdio>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+/**
+ * @brief Log of how the bounds of the searches move over time, enabled by -trace FILE.
+ *
+ * Every engine that searches a graph is a Source of the trace; it writes a record when it starts, whenever its lower or
+ * upper bound changes, when it ends, and in between every #interval seconds. The periodic records are only written
+ * from the points where the engines already read the clock for their deadline, so while the trace is closed (the
+ * default) a source costs a single branch there and nothing anywhere else.
+ *
+ * The file is CSV, one record per line:
+ *   time_ms,source,event,nodes,lower_bound,upper_bound,open_nodes,depth
+ * time since open(), the number of the source, the event (s start, b bound change, p periodic, e end), the nodes the
+ * source has searched, its bounds, and its open nodes and depth where the search knows them (empty otherwise).
+ * Lines starting with # describe the sources.
+ */
+class ProgressTrace {
+public:
+    enum Event { event_start = 's', event_bound = 'b', event_periodic = 'p', event_end = 'e' };
+
+    /**
+     * @brief Start tracing into #fileName, with periodic records every #intervalSeconds; time 0 is now
+     * @return false if the file cannot be written
+     */
+    static bool open(const std::string& fileName, double intervalSeconds) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.lock);
+        if (s.file) std::fclose(s.file);
+        s.file = std::fopen(fileName.c_str(), "w");
+        if (!s.file) return false;
+        std::setvbuf(s.file, nullptr, _IOFBF, 1 << 16);
+        s.start = std::chrono::steady_clock::now();
+        s.intervalMicros = (long long)(intervalSeconds * 1e6);
+        std::fprintf(s.file, "# events: s start, b bound change, p every %g s, e end\n", intervalSeconds);
+        std::fprintf(s.file, "time_ms,source,event,nodes,lower_bound,upper_bound,open_nodes,depth\n");
+        return true;
+    }
+
+    static void close() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.lock);
+        if (s.file) std::fclose(s.file);
+        s.file = nullptr;
+    }
+
+    static bool enabled() { return state().file != nullptr; }
+
+    /**
+     * @brief One search writing to the trace; inactive until start() is called while the trace is open
+     */
+    class Source {
+    public:
+        Source() : id(0), nextDue(0) {}
+
+        /**
+         * @brief Register as a new source, named #engine, searching a graph of #numVertices vertices
+         */
+        void start(const char* engine, int numVertices) {
+            if (!enabled()) return;
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.lock);
+            if (!s.file) return;
+            id = ++s.numSources;
+            std::fprintf(s.file, "# source %d: %s, %d vertices\n", id, engine, numVertices);
+        }
+
+        bool active() const { return id != 0; }
+
+        /**
+         * @brief Write a record unless the last one of this source is less than the interval ago; called every few
+         * nodes, from any thread of the search
+         */
+        void poll(long nodes, int lowerBound, int upperBound, long openNodes = -1, int depth = -1) {
+            if (!id) return;
+            long long now = elapsedMicros();
+            long long due = nextDue.load(std::memory_order_relaxed);
+            // of the threads that find the record due, only the one that moves the due time on writes it
+            if (now < due || !nextDue.compare_exchange_strong(due, now + state().intervalMicros)) return;
+            write(now, event_periodic, nodes, lowerBound, upperBound, openNodes, depth);
+        }
+
+        /**
+         * @brief Write a record now; the next periodic one follows an interval later
+         */
+        void record(Event event, long nodes, int lowerBound, int upperBound, long openNodes = -1, int depth = -1) {
+            if (!id) return;
+            long long now = elapsedMicros();
+            nextDue.store(now + state().intervalMicros, std::memory_order_relaxed);
+            write(now, event, nodes, lowerBound, upperBound, openNodes, depth);
+        }
+
+    private:
+        int id;
+        std::atomic<long long> nextDue;     // microseconds since open()
+
+        void write(long long micros, Event event, long nodes, int lowerBound, int upperBound, long openNodes, int depth) {
+            char open[24] = "", level[16] = "";
+            if (openNodes >= 0) std::snprintf(open, sizeof(open), "%ld", openNodes);
+            if (depth >= 0) std::snprintf(level, sizeof(level), "%d", depth);
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.lock);
+            if (!s.file) return;
+            std::fprintf(s.file, "%.3f,%d,%c,%ld,%d,%d,%s,%s\n", micros / 1e3, id, (char)event, nodes, lowerBound,
+                upperBound, open, level);
+            // bound changes are rare and the ones worth seeing while a long run is still going
+            if (event != event_periodic) std::fflush(s.file);
+        }
+    };
+
+private:
+    struct State {
+        std::mutex lock;
+        std::FILE* file;
+        std::chrono::steady_clock::time_point start;
+        long long intervalMicros;
+        int numSources;
+        State() : file(nullptr), intervalMicros(0), numSources(0) {}
+        ~State() { if (file) std::fclose(file); }
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    static long long elapsedMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - state().start).count();
+    }
+};
+
+#endif // PROGRESS_TRACE_H
@@ -0,0 +1,122 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+/**
+ * @brief Counters and phase timers of the search, enabled by -stats.
+ *
+ * Every thread counts into its own block, padded so that no two threads ever write to the same cache line;
+ * the blocks are only summed when the summary is printed. While disabled (the default), counting and timing is a
+ * single predictable branch and no clock is read.
+ * The blocks outlive their threads, so the summary covers every thread that ever searched.
+ */
+class SearchStats {
+public:
+    enum Counter { nodes_expanded, nodes_pruned, merges, edge_additions, num_counters };
+    enum Phase { phase_clique, phase_coloring, phase_branching, phase_copy, num_phases };
+
+    static void enable(bool value = true) { enabledFlag() = value; }
+    static bool enabled() { return enabledFlag(); }
+
+    static void count(Counter c) {
+        if (enabled()) local().counters[c]++;
+    }
+
+    /**
+     * @brief Adds the time from its construction to its destruction to #phase of the calling thread
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Phase phase) : phase(phase), running(SearchStats::enabled()) {
+            if (running) start = std::chrono::steady_clock::now();
+        }
+        ~ScopedTimer() {
+            if (!running) return;
+            ThreadBlock& block = local();
+            block.phaseNanos[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            block.phaseCalls[phase]++;
+        }
+    private:
+        Phase phase;
+        bool running;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /**
+     * @brief Print the counters and, per phase, the number of calls and the time summed over all threads
+     */
+    static void print(std::ostream& out) {
+        static const char* counterNames[num_counters] = {"nodes expanded", "nodes pruned", "merges", "edge additions"};
+        static const char* phaseNames[num_phases] = {"clique bound", "coloring bound", "branching choice", "node copy"};
+        std::lock_guard<std::mutex> lock(registry().lock);
+        const std::vector<std::unique_ptr<ThreadBlock> >& blocks = registry().blocks;
+        long counters[num_counters] = {}, calls[num_phases] = {};
+        long long nanos[num_phases] = {}, totalNanos = 0;
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            for (int c = 0; c < num_counters; ++c) counters[c] += blocks[i]->counters[c];
+            for (int p = 0; p < num_phases; ++p) {
+                calls[p] += blocks[i]->phaseCalls[p];
+                nanos[p] += blocks[i]->phaseNanos[p];
+                totalNanos += blocks[i]->phaseNanos[p];
+            }
+        }
+        out << "\nSearch statistics (" << blocks.size() << " threads):" << std::endl;
+        for (int c = 0; c < num_counters; ++c)
+            out << "  " << std::left << std::setw(18) << counterNames[c] << std::right << std::setw(14) << counters[c] << std::endl;
+        out << "  " << std::left << std::setw(18) << "phase" << std::right << std::setw(14) << "calls"
+            << std::setw(12) << "ms" << std::setw(10) << "us/call" << std::setw(8) << "share" << std::endl;
+        for (int p = 0; p < num_phases; ++p) {
+            out << "  " << std::left << std::setw(18) << phaseNames[p] << std::right << std::setw(14) << calls[p]
+                << std::fixed << std::setprecision(1)
+                << std::setw(12) << nanos[p] / 1e6
+                << std::setw(10) << (calls[p] ? nanos[p] / 1e3 / calls[p] : 0.0)
+                << std::setw(7) << (totalNanos ? 100.0 * nanos[p] / totalNanos : 0.0) << "%" << std::endl;
+        }
+        out.unsetf(std::ios::floatfield);
+    }
+
+private:
+    // padded by a cache line on both sides, since operator new does not honour alignas(64) before C++17
+    struct ThreadBlock {
+        char paddingBefore[64];
+        long counters[num_counters];
+        long phaseCalls[num_phases];
+        long long phaseNanos[num_phases];
+        char paddingAfter[64];
+        ThreadBlock() : counters(), phaseCalls(), phaseNanos() {}
+    };
+
+    struct Registry {
+        std::mutex lock;
+        std::vector<std::unique_ptr<ThreadBlock> > blocks;
+    };
+
+    static bool& enabledFlag() {
+        static bool flag = false;
+        return flag;
+    }
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    static ThreadBlock& local() {
+        static thread_local ThreadBlock* block = nullptr;
+        if (!block) {
+            std::lock_guard<std::mutex> lock(registry().lock);
+            registry().blocks.emplace_back(new ThreadBlock());
+            block = registry().blocks.back().get();
+        }
+        return *block;
+    }
+};
+
+#endif // SEARCH_STATS_H
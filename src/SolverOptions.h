@@ -0,0 +1,115 @@
+#ifndef SOLVER_OPTIONS_H
+#define SOLVER_OPTIONS_H
+
+#include <string>
+#include <cstddef>
+#include <chrono>
+
+/**
+ * @brief Settings of the coloring search, filled in from the command line and passed down to every solver
+ */
+struct SolverOptions {
+    enum SearchMode {
+        search_recursive,   // depth-first recursion, one stack frame per branching level
+        search_iterative,   // depth-first with an explicit stack of pooled nodes
+        search_tasks,       // OpenMP tasks down to taskCutoffDepth, iterative below it
+        search_stealing     // one work-stealing deque per thread
+    };
+
+    enum Engine {
+        engine_zykov,       // merge / add-edge branching on pairs of non-adjacent vertices
+        engine_dsatur,      // DSATUR: color the most saturated vertex with each possible color
+        engine_cdcl,        // k-colorability with nogood learning, for k = upper bound - 1 downwards
+        engine_portfolio    // all of the above concurrently, sharing bounds; the first to finish stops the others
+    };
+
+    enum NodeOrder {
+        order_dfs,          // depth-first, merge child first
+        order_best,         // best-first by node lower bound
+        order_hybrid        // best-first while at most maxOpenNodes nodes are open, depth-first dives above that
+    };
+
+    enum BranchingRule {
+        branching_degree,   // the non-adjacent pair with the largest degree sum
+        branching_common    // the non-adjacent pair with the most common neighbours
+    };
+
+    SearchMode searchMode = search_iterative;
+    Engine engine = engine_zykov;
+    NodeOrder nodeOrder = order_dfs;        // used by the iterative search; the parallel ones are depth-first
+    size_t maxOpenNodes = 100000;
+    BranchingRule branchingRule = branching_degree;
+    int taskCutoffDepth = 12;       // nodes deeper than this are not split into tasks any more
+    bool debugOutput = false;
+    bool distributed = false;       // search across all MPI ranks (only with USE_MPI)
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    /**
+     * @brief Stop the searches #seconds from now; 0 or less means no time limit
+     */
+    void setTimeLimit(double seconds) {
+        if (seconds <= 0)
+            deadline = std::chrono::steady_clock::time_point::max();
+        else
+            deadline = std::chrono::steady_clock::now()
+                + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    bool hasDeadline() const { return deadline != std::chrono::steady_clock::time_point::max(); }
+
+    /**
+     * @brief Whether the deadline has passed; reads the clock, so searches call it only every few nodes
+     */
+    bool deadlinePassed() const { return hasDeadline() && std::chrono::steady_clock::now() >= deadline; }
+
+    /**
+     * @brief Set the search mode from its command line name
+     * @return false if the name is unknown
+     */
+    bool setSearchMode(const std::string& name) {
+        if (name == "recursive") searchMode = search_recursive;
+        else if (name == "iterative") searchMode = search_iterative;
+        else if (name == "tasks") searchMode = search_tasks;
+        else if (name == "stealing") searchMode = search_stealing;
+        else return false;
+        return true;
+    }
+
+    /**
+     * @brief Set the node order from its command line name
+     * @return false if the name is unknown
+     */
+    bool setNodeOrder(const std::string& name) {
+        if (name == "dfs") nodeOrder = order_dfs;
+        else if (name == "best") nodeOrder = order_best;
+        else if (name == "hybrid") nodeOrder = order_hybrid;
+        else return false;
+        return true;
+    }
+
+    /**
+     * @brief Set the Zykov branching rule from its command line name
+     * @return false if the name is unknown
+     */
+    bool setBranchingRule(const std::string& name) {
+        if (name == "degree") branchingRule = branching_degree;
+        else if (name == "common") branchingRule = branching_common;
+        else return false;
+        return true;
+    }
+
+    /**
+     * @brief Set the exact engine from its command line name
+     * @return false if the name is unknown
+     */
+    bool setEngine(const std::string& name) {
+        if (name == "zykov") engine = engine_zykov;
+        else if (name == "dsatur") engine = engine_dsatur;
+        else if (name == "cdcl") engine = engine_cdcl;
+        else if (name == "portfolio") engine = engine_portfolio;
+        else return false;
+        return true;
+    }
+};
+
+#endif // SOLVER_OPTIONS_H
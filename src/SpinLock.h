@@ -0,0 +1,35 @@
+#ifndef SPIN_LOCK_H
+#define SPIN_LOCK_H
+
+#include <atomic>
+
+/**
+ * @brief A minimal test-and-test-and-set spin lock, for short critical sections that are rarely contended 
+ * (e.g. publishing an improved coloring). Usable with std::lock_guard.
+ */
+class SpinLock {
+public:
+    SpinLock() : locked(false) {}
+
+    void lock() {
+        while (true) {
+            if (!locked.exchange(true, std::memory_order_acquire))
+                return;
+            while (locked.load(std::memory_order_relaxed))
+                __builtin_ia32_pause();
+        }
+    }
+
+    bool try_lock() {
+        return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() {
+        locked.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> locked;
+};
+
+#endif // SPIN_LOCK_H
@@ -5,7 +5,20 @@
 #include <algorithm>
 #include <limits>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <unordered_map>
 #include "Graph.h"
+#include "NodePool.h"
+#include "SolverOptions.h"
+#include "SpinLock.h"
+#include "SearchStats.h"
+#include "ProgressTrace.h"
+#include "WorkStealingScheduler.h"
 #include <VectorSet.h>
 #include <omp.h>
 #include <unordered_set>
@@ -18,33 +31,92 @@ public:
     VectorT maxClique;
     std::vector<int> diffNeighbors;
 
-    VertexColoring(Graph<VectorT>& g);
-    int findChromaticNumber();
+    VertexColoring(Graph<VectorT>& g, const SolverOptions& options = SolverOptions());
+    int findChromaticNumber(int knownLowerBound = 0);
+    bool initializeBounds(int knownLowerBound = 0);
+    int getLowerBound() const { return globalLowerBound; }
+    int getUpperBound() const { return globalUpperBound; }
+    long getNumNodes() const { return numNodes.load(); }
+
+    /**
+     * @brief Lower the upper bound used for pruning to #upperBound, found elsewhere (e.g. by another MPI rank); 
+     * #bestColoring is not changed, it only gets replaced by colorings with fewer colors than that
+     */
+    void importUpperBound(int upperBound) {
+        int current = globalUpperBound.load();
+        while(upperBound < current) {
+            if(globalUpperBound.compare_exchange_weak(current, upperBound)) {
+                traceProgress(ProgressTrace::event_bound);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Make every search engine return as soon as possible; #bestColoring keeps the best coloring found so far.
+     * The search requests this itself once the deadline of its options has passed.
+     */
+    void requestStop() { stopRequested = true; }
+    bool isStopRequested() const { return stopRequested.load(); }
+
+    /**
+     * @brief Call #callback after every #interval evaluated nodes, from the thread that evaluated the node
+     */
+    void setPollCallback(long interval, std::function<void()> callback) {
+        pollInterval = interval;
+        pollCallback = callback;
+    }
     bool isProperlyColored(const std::vector<int>& coloring);
 
+    /**
+     * @brief Write the progress of this search to the trace, if one is open, as the source #engine from now on;
+     * called once the root bounds are known (see initializeBounds())
+     */
+    void startTrace(const char* engine) {
+        trace.start(engine, graph.getNumVertices());
+        traceProgress(ProgressTrace::event_start);
+    }
+
+    /**
+     * @brief Write the current bounds and node count to the trace (nothing if startTrace() was not called)
+     */
+    void traceProgress(ProgressTrace::Event event, long numOpenNodes = -1, int depth = -1) {
+        trace.record(event, numNodes.load(std::memory_order_relaxed), globalLowerBound, globalUpperBound, numOpenNodes, depth);
+    }
+
+    /**
+     * @brief A subproblem of Zykov's branching: the graph with some non-adjacent pairs merged and some edges added.
+     * A merged-away vertex is deactivated and loses its edges, so the active vertices induce the contracted graph.
+     */
     struct Node {
         Graph<VectorT> graph;
-        std::vector<bool> isActive;
+        BitSet isActive;                // the vertices not merged away; they induce the contracted graph
+        std::vector<int> mergedInto;    // for an inactive vertex, the vertex it was merged into; -1 for active vertices
         int numActiveVertices;
         int lowerBound;
         int upperBound;
+        int depth;
         
         // Constructor
         explicit Node(const Graph<VectorT>& g) : 
             graph(g), 
             isActive(g.getNumVertices(), true),
+            mergedInto(g.getNumVertices(), -1),
             numActiveVertices(g.getNumVertices()),
             lowerBound(0),
-            upperBound(g.getNumVertices())
+            upperBound(g.getNumVertices()),
+            depth(0)
         {}
 
         // Copy constructor
         Node(const Node& other) : 
             graph(other.graph),
             isActive(other.isActive),
+            mergedInto(other.mergedInto),
             numActiveVertices(other.numActiveVertices),
             lowerBound(other.lowerBound),
-            upperBound(other.upperBound)
+            upperBound(other.upperBound),
+            depth(other.depth)
         {}
 
         // Assignment operator
@@ -52,9 +124,11 @@ public:
             if(this != &other) {
                 graph = other.graph;
                 isActive = other.isActive;
+                mergedInto = other.mergedInto;
                 numActiveVertices = other.numActiveVertices;
                 lowerBound = other.lowerBound;
                 upperBound = other.upperBound;
+                depth = other.depth;
             }
             return *this;
         }
@@ -62,43 +136,134 @@ public:
         // Helper methods
         void deactivateVertex(int v) {
             if(v >= 0 && v < (int)isActive.size() && isActive[v]) {
-                isActive[v] = false;
+                isActive.reset(v);
                 numActiveVertices--;
             }
         }
 
+        /**
+         * @brief The active vertices in increasing order; allocates, so the search iterates #isActive instead
+         */
         std::vector<int> getActiveVertices() const {
             std::vector<int> active;
             active.reserve(numActiveVertices);
-            for(int i = 0; i < (int)isActive.size(); i++) {
-                if(isActive[i]) {
-                    active.push_back(i);
-                }
-            }
+            isActive.forEach([&](size_t v) { active.push_back(v); });
             return active;
         }
+
+        /**
+         * @brief The active vertex that #v has been merged into (v itself if it is active)
+         */
+        int representative(int v) const {
+            while(mergedInto[v] >= 0) v = mergedInto[v];
+            return v;
+        }
     };
 
+    /**
+     * @brief Choose the pair of non-adjacent active vertices to branch on, by SolverOptions::branchingRule: the largest 
+     * degree sum, or the most common neighbours (ties broken by the degree sum).
+     *
+     * Merges and added edges keep the degrees up to date, so the active vertices are put in descending order of degree
+     * with a counting sort, and the scan stops as soon as no pair of the remaining vertices can beat the best one.
+     * @return the pair, or {-1, -1} if the active vertices form a clique
+     */
     std::pair<int, int> chooseBranchingVertices(const Node& node) const {
-        int v1 = -1, v2 = -1;
-        int maxDegree = -1;
-        
-        auto activeVerts = node.getActiveVertices();
-        for(size_t i = 0; i < activeVerts.size(); i++) {
-            int vi = activeVerts[i];
-            for(size_t j = i + 1; j < activeVerts.size(); j++) {
-                int vj = activeVerts[j];
-                if(!node.graph.areNeighbours(vi, vj)) {
-                    int combinedDegree = node.graph.getDegree(vi) + node.graph.getDegree(vj);
-                    if(combinedDegree > maxDegree) {
-                        maxDegree = combinedDegree;
-                        v1 = vi;
-                        v2 = vj;
-                    }
+        static thread_local std::vector<int> order, bucketStart;
+        sortActiveByDegree(node, order, bucketStart);
+        if(options.branchingRule == SolverOptions::branching_common) {
+            return chooseByCommonNeighbours(node, order);
+        }
+        return chooseByDegreeSum(node, order);
+    }
+
+    /**
+     * @brief Fill #order with the active vertices of #node in descending order of degree (stable by index)
+     */
+    void sortActiveByDegree(const Node& node, std::vector<int>& order, std::vector<int>& bucketStart) const {
+        bucketStart.assign(node.numActiveVertices + 1, 0);
+        // merged-away vertices are isolated, so an active vertex has fewer active neighbours than there are active vertices
+        node.isActive.forEach([&](size_t v) {
+            bucketStart[node.numActiveVertices - 1 - node.graph.getDegree(v)]++;
+        });
+        int sum = 0;
+        for(size_t d = 0; d < bucketStart.size(); d++) {
+            int count = bucketStart[d];
+            bucketStart[d] = sum;
+            sum += count;
+        }
+        order.resize(sum);
+        node.isActive.forEach([&](size_t v) {
+            order[bucketStart[node.numActiveVertices - 1 - node.graph.getDegree(v)]++] = v;
+        });
+    }
+
+    std::pair<int, int> chooseByDegreeSum(const Node& node, const std::vector<int>& order) const {
+        const Graph<VectorT>& g = node.graph;
+        std::pair<int, int> best(-1, -1);
+        int bestSum = -1;
+        for(size_t i = 0; i + 1 < order.size(); i++) {
+            int u = order[i];
+            int du = g.getDegree(u);
+            if(du + g.getDegree(order[i + 1]) < bestSum) break;
+            // partners in degree order: the first non-neighbour has the largest sum, later ones can only tie with it
+            for(size_t j = i + 1; j < order.size(); j++) {
+                int v = order[j];
+                int sum = du + g.getDegree(v);
+                if(sum < bestSum) break;
+                if(g.adjacencyMatrix[u][v]) continue;
+                // among equal sums, the pair that comes first in index order, as the full scan chose it
+                std::pair<int, int> pair(std::min(u, v), std::max(u, v));
+                if(sum > bestSum || pair < best) {
+                    bestSum = sum;
+                    best = pair;
+                }
+            }
+        }
+        return best;
+    }
+
+    std::pair<int, int> chooseByCommonNeighbours(const Node& node, const std::vector<int>& order) const {
+        const Graph<VectorT>& g = node.graph;
+        std::pair<int, int> best(-1, -1);
+        int bestCommon = -1, bestSum = -1;
+        for(size_t i = 0; i < order.size(); i++) {
+            int u = order[i];
+            int du = g.getDegree(u);
+            // u and any later vertex have at most min(du, dv) = dv common neighbours
+            if(du < bestCommon) break;
+            for(size_t j = i + 1; j < order.size(); j++) {
+                int v = order[j];
+                int dv = g.getDegree(v);
+                if(dv < bestCommon) break;
+                if(g.adjacencyMatrix[u][v]) continue;
+                int common = g.adjacencyMatrix[u].intersectionCount(g.adjacencyMatrix[v]);
+                if(common > bestCommon || (common == bestCommon && du + dv > bestSum)) {
+                    bestCommon = common;
+                    bestSum = du + dv;
+                    best = std::make_pair(u, v);
                 }
             }
         }
-        return {v1, v2};
+        return best;
+    }
+
+    /**
+     * @brief Merge #v2 into #v1 in place: #v1 gets the union of both neighbourhoods, #v2 is deactivated
+     */
+    void mergeVerticesInPlace(Node& node, int v1, int v2) const {
+        SearchStats::count(SearchStats::merges);
+        // a merged-away vertex has no edges left, so the row of v2 holds exactly its active neighbours (v1 is not one)
+        node.graph.mergeNeighbourhoods(v1, v2);
+        node.deactivateVertex(v2);
+        node.mergedInto[v2] = v1;
+        node.depth++;
+    }
+
+    void addEdgeInPlace(Node& node, int v1, int v2) const {
+        SearchStats::count(SearchStats::edge_additions);
+        node.graph.setNeighbours(v1, v2, true);
+        node.depth++;
     }
 
     Node mergeVertices(const Node& parent, int v1, int v2) const {
@@ -110,21 +275,7 @@ public:
             }
 
             Node newNode(parent);
-            
-            // Update edges
-            auto activeVerts = newNode.getActiveVertices();
-            for(int vi : activeVerts) {
-                if(vi != v1 && vi != v2) {
-                    bool shouldConnect = newNode.graph.areNeighbours(vi, v1) || 
-                                      newNode.graph.areNeighbours(vi, v2);
-                    newNode.graph.setNeighbours(vi, v1, shouldConnect);
-                    newNode.graph.setNeighbours(v1, vi, shouldConnect);
-                }
-            }
-            
-            // Deactivate v2
-            newNode.deactivateVertex(v2);
-            
+            mergeVerticesInPlace(newNode, v1, v2);
             return newNode;
         } catch(const std::exception& e) {
             std::cout << "Error in mergeVertices: " << e.what() << std::endl;
@@ -141,7 +292,7 @@ public:
             }
 
             Node newNode(parent);
-            newNode.graph.setNeighbours(v1, v2, true);
+            addEdgeInPlace(newNode, v1, v2);
             return newNode;
         } catch(const std::exception& e) {
             std::cout << "Error in addEdge: " << e.what() << std::endl;
@@ -149,72 +300,394 @@ public:
         }
     }
 
-    void branchAndBoundSequential(Node& node) {
-        try {
-            if(debugOut) {
-                std::cout << "\nCurrent node stats:" << std::endl;
-                std::cout << "Active vertices: " << node.numActiveVertices << std::endl;
-                std::cout << "Current lower bound: " << globalLowerBound << std::endl;
-                std::cout << "Current upper bound: " << globalUpperBound << std::endl;
+    /**
+     * @brief Bound #node: a clique gives its lower bound, a greedy coloring its upper bound (which improves the best 
+     * coloring if it uses fewer colors). Then choose the vertices to branch on.
+     * @param numOpenNodes  the size of the caller's frontier, for the progress trace; -1 if it has none
+     * @return the branching pair, or {-1, -1} if the subtree of #node cannot improve the best coloring
+     */
+    std::pair<int, int> evaluateNode(Node& node, long numOpenNodes = -1) {
+        long count = numNodes.fetch_add(1, std::memory_order_relaxed) + 1;
+        SearchStats::count(SearchStats::nodes_expanded);
+        if(pollCallback && count % pollInterval == 0) {
+            pollCallback();
+        }
+        if(count % deadlineCheckInterval == 0) {
+            if(options.deadlinePassed()) {
+                requestStop();
             }
+            trace.poll(count, globalLowerBound, globalUpperBound, numOpenNodes, node.depth);
+        }
 
-            // Base cases
-            if(node.numActiveVertices <= 1 || globalLowerBound == globalUpperBound) {
-                return;
-            }
+        if(debugOut) {
+            std::cout << "\nCurrent node stats:" << std::endl;
+            std::cout << "Active vertices: " << node.numActiveVertices << std::endl;
+            std::cout << "Current lower bound: " << globalLowerBound << std::endl;
+            std::cout << "Current upper bound: " << globalUpperBound << std::endl;
+        }
 
-            // Calculate bounds for current node
-            VectorT clique = node.graph.findMaxCliqueApprox();
-            node.lowerBound = clique.size();
-            
-            std::vector<int> initialColoring(node.graph.getNumVertices(), -1);
-            for(size_t i = 0; i < clique.size(); i++) {
-                initialColoring[clique[i]] = i;
+        // Calculate bounds for current node; merged-away vertices are isolated, so the clique is in the contracted graph
+        static thread_local VectorT clique;
+        static thread_local std::vector<int> colors;
+        {
+            SearchStats::ScopedTimer timer(SearchStats::phase_clique);
+            node.graph.findMaxCliqueApprox(clique);
+        }
+        node.lowerBound = clique.size();
+        
+        colors.assign(node.graph.getNumVertices(), -1);
+        for(size_t i = 0; i < clique.size(); i++) {
+            if(node.isActive[clique[i]])
+                colors[clique[i]] = i;
+        }
+        node.upperBound = greedyColoring(node, colors);
+        
+        // Update the best coloring
+        if(node.upperBound < globalUpperBound) {
+            bool improved = false;
+            {
+                std::lock_guard<SpinLock> lock(bestColoringLock);
+                if(node.upperBound < globalUpperBound) {
+                    globalUpperBound = node.upperBound;
+                    bestColoring = colors;
+                    improved = true;
+                }
             }
-            node.upperBound = greedyColoring(initialColoring);
-            
-            // Update global bounds
-            globalLowerBound = std::max(globalLowerBound, node.lowerBound);
-            globalUpperBound = std::min(globalUpperBound, node.upperBound);
-            
-            if(debugOut) {
-                std::cout << "Node bounds - Lower: " << node.lowerBound 
-                         << ", Upper: " << node.upperBound << std::endl;
+            if(improved) {
+                traceProgress(ProgressTrace::event_bound, numOpenNodes, node.depth);
             }
+        }
+        
+        if(debugOut) {
+            std::cout << "Node bounds - Lower: " << node.lowerBound 
+                     << ", Upper: " << node.upperBound << std::endl;
+        }
 
-            // Choose vertices for branching
-            auto vertices = chooseBranchingVertices(node);
-            if(vertices.first == -1 || vertices.second == -1) {
+        // Prune: no coloring in this subtree can use fewer colors than the best one
+        if(node.lowerBound >= globalUpperBound || node.lowerBound == node.upperBound) {
+            SearchStats::count(SearchStats::nodes_pruned);
+            return {-1, -1};
+        }
+
+        // Choose vertices for branching
+        std::pair<int, int> vertices;
+        {
+            SearchStats::ScopedTimer timer(SearchStats::phase_branching);
+            vertices = chooseBranchingVertices(node);
+        }
+        if(vertices.first == -1) {
+            SearchStats::count(SearchStats::nodes_pruned);
+        }
+        if(debugOut && vertices.first != -1) {
+            std::cout << "Branching on vertices " << vertices.first << " and " 
+                     << vertices.second << std::endl;
+        }
+        return vertices;
+    }
+
+    void branchAndBoundSequential(Node& node) {
+        branchAndBoundSequential(node, threadPool());
+    }
+
+    /**
+     * @brief Depth-first recursion; the children of #node are drawn from #pool, and each child's whole subtree is
+     * given back to it at once when the child has been searched
+     */
+    void branchAndBoundSequential(Node& node, NodePool<Node>& pool) {
+        typename NodePool<Node>::Mark mark = pool.mark();
+        try {
+            // Base cases
+            if(node.numActiveVertices <= 1 || searchFinished()) {
                 return;
             }
 
-            if(debugOut) {
-                std::cout << "Branching on vertices " << vertices.first << " and " 
-                         << vertices.second << std::endl;
+            auto vertices = evaluateNode(node);
+            if(vertices.first == -1 || vertices.second == -1) {
+                return;
             }
 
             // Branch 1: Merge vertices
-            Node mergedNode = mergeVertices(node, vertices.first, vertices.second);
-            if(mergedNode.numActiveVertices < node.numActiveVertices) {
-                branchAndBoundSequential(mergedNode);
-            }
+            Node* mergedNode = copyNode(pool, node);
+            mergeVerticesInPlace(*mergedNode, vertices.first, vertices.second);
+            branchAndBoundSequential(*mergedNode, pool);
+            pool.releaseTo(mark);
 
             // Branch 2: Add edge (only if we haven't found optimal solution)
-            if(globalLowerBound < globalUpperBound) {
-                Node edgeNode = addEdge(node, vertices.first, vertices.second);
-                branchAndBoundSequential(edgeNode);
+            if(!searchFinished()) {
+                Node* edgeNode = copyNode(pool, node);
+                addEdgeInPlace(*edgeNode, vertices.first, vertices.second);
+                branchAndBoundSequential(*edgeNode, pool);
+                pool.releaseTo(mark);
             }
         } catch(const std::exception& e) {
             std::cout << "Error in branchAndBoundSequential: " << e.what() << std::endl;
         }
+        pool.releaseTo(mark);
+    }
+
+    /**
+     * @brief The same search as #branchAndBoundSequential, but with open nodes kept on an explicit stack.
+     * 
+     * Nodes come from the calling thread's pool and are recycled once expanded; an expanded node becomes its own merge
+     * child, so each expansion copies a single node (for the add-edge child). Whatever is left when the search stops
+     * goes back to the pool at once. The merge child is pushed last, so it is explored first.
+     */
+    void branchAndBoundIterative(const Node& root) {
+        NodePool<Node>& pool = threadPool();
+        typename NodePool<Node>::Mark mark = pool.mark();
+        try {
+            std::vector<Node*> stack;
+            stack.reserve(root.numActiveVertices + 2);
+            stack.push_back(copyNode(pool, root));
+
+            while(!stack.empty()) {
+                Node* node = stack.back();
+                stack.pop_back();
+
+                if(node->numActiveVertices <= 1 || searchFinished()) {
+                    pool.release(node);
+                    continue;
+                }
+
+                auto vertices = evaluateNode(*node, stack.size());
+                if(vertices.first == -1 || vertices.second == -1) {
+                    pool.release(node);
+                    continue;
+                }
+
+                Node* edgeNode = copyNode(pool, *node);
+                addEdgeInPlace(*edgeNode, vertices.first, vertices.second);
+                stack.push_back(edgeNode);
+
+                mergeVerticesInPlace(*node, vertices.first, vertices.second);
+                stack.push_back(node);
+            }
+        } catch(const std::exception& e) {
+            std::cout << "Error in branchAndBoundIterative: " << e.what() << std::endl;
+        }
+        pool.releaseTo(mark);
+    }
+
+    /**
+     * @brief A compact handle of an evaluated open node, for the priority queue of #branchAndBoundBestFirst
+     */
+    struct OpenNode {
+        int lowerBound;     // valid for the whole subtree: the larger of the node's clique bound and its parent's bound
+        int upperBound;     // colors used by the node's greedy coloring
+        int depth;
+        int numActiveVertices;
+        int v1, v2;         // the branching pair chosen when the node was evaluated
+        Node* node;
+
+        // std::priority_queue puts the largest element on top: the smallest lower bound, then the smallest upper bound
+        // (the node closest to a coloring with that many colors), then the deepest node, then the smaller contracted
+        // graph (a merge child before its add-edge sibling, as in depth-first order)
+        bool operator<(const OpenNode& other) const {
+            if(lowerBound != other.lowerBound) return lowerBound > other.lowerBound;
+            if(upperBound != other.upperBound) return upperBound > other.upperBound;
+            if(depth != other.depth) return depth < other.depth;
+            return numActiveVertices > other.numActiveVertices;
+        }
+    };
+
+    /**
+     * @brief Search in best-first order: nodes are evaluated when they are created, and the open node with the smallest
+     * lower bound is expanded next. The smallest bound of the open nodes is a lower bound for the whole graph, so
+     * optimality is proven as soon as it reaches the best coloring.
+     *
+     * With SolverOptions::order_hybrid, once more than SolverOptions::maxOpenNodes nodes are open the search dives
+     * depth-first (merge child first) from the node it expands, which keeps the number of open nodes near that limit,
+     * and returns to best-first order when enough of them have been pruned.
+     */
+    void branchAndBoundBestFirst(const Node& root) {
+        NodePool<Node>& pool = threadPool();
+        typename NodePool<Node>::Mark mark = pool.mark();
+        try {
+            std::priority_queue<OpenNode> queue;
+            std::vector<OpenNode> dive;
+            bool hybrid = (options.nodeOrder == SolverOptions::order_hybrid);
+
+            // evaluate a new node and put it in the queue or on the dive stack, unless it is pruned
+            auto open = [&](Node* node, int parentBound, bool diving) {
+                if(node->numActiveVertices <= 1 || searchFinished()) {
+                    pool.release(node);
+                    return;
+                }
+                auto vertices = evaluateNode(*node, queue.size() + dive.size());
+                int bound = std::max(node->lowerBound, parentBound);
+                if(vertices.first == -1 || vertices.second == -1 || bound >= globalUpperBound) {
+                    pool.release(node);
+                    return;
+                }
+                OpenNode handle = {bound, node->upperBound, node->depth, node->numActiveVertices, vertices.first, vertices.second, node};
+                if(diving) dive.push_back(handle);
+                else queue.push(handle);
+            };
+
+            open(copyNode(pool, root), globalLowerBound, false);
+            while((!queue.empty() || !dive.empty()) && !searchFinished()) {
+                bool diving = hybrid && queue.size() + dive.size() > options.maxOpenNodes;
+                if(!diving) {
+                    for(size_t i = 0; i < dive.size(); i++) queue.push(dive[i]);
+                    dive.clear();
+                    // the whole frontier is in the queue, so its smallest bound holds for the rest of the search
+                    raiseLowerBound(std::min(queue.top().lowerBound, globalUpperBound.load()));
+                }
+
+                OpenNode current;
+                if(!dive.empty()) {
+                    current = dive.back();
+                    dive.pop_back();
+                } else {
+                    current = queue.top();
+                    queue.pop();
+                }
+                if(current.lowerBound >= globalUpperBound) {
+                    pool.release(current.node);
+                    continue;
+                }
+
+                Node* edgeNode = copyNode(pool, *current.node);
+                addEdgeInPlace(*edgeNode, current.v1, current.v2);
+                mergeVerticesInPlace(*current.node, current.v1, current.v2);
+                open(edgeNode, current.lowerBound, diving);
+                open(current.node, current.lowerBound, diving);
+            }
+        } catch(const std::exception& e) {
+            std::cout << "Error in branchAndBoundBestFirst: " << e.what() << std::endl;
+        }
+        pool.releaseTo(mark);
+    }
+
+    /**
+     * @brief Parallel version of #branchAndBoundSequential: the add-edge subtree of every node shallower than the cutoff 
+     * depth is spawned as an OpenMP task, while the current task dives into the merge subtree; below the cutoff
+     * each subtree is searched by #branchAndBoundIterative. Must be called from within a parallel region.
+     * @param node  the node to expand; owned (and deleted) by this call
+     */
+    void branchAndBoundParallel(Node* node) {
+        try {
+            while(node->depth < options.taskCutoffDepth) {
+                if(node->numActiveVertices <= 1 || searchFinished()) {
+                    delete node;
+                    return;
+                }
+
+                auto vertices = evaluateNode(*node);
+                if(vertices.first == -1 || vertices.second == -1) {
+                    delete node;
+                    return;
+                }
+
+                Node* edgeNode;
+                {
+                    SearchStats::ScopedTimer timer(SearchStats::phase_copy);
+                    edgeNode = new Node(*node);
+                }
+                addEdgeInPlace(*edgeNode, vertices.first, vertices.second);
+                #pragma omp task firstprivate(edgeNode)
+                branchAndBoundParallel(edgeNode);
+
+                mergeVerticesInPlace(*node, vertices.first, vertices.second);
+            }
+            branchAndBoundIterative(*node);
+        } catch(const std::exception& e) {
+            std::cout << "Error in branchAndBoundParallel: " << e.what() << std::endl;
+        }
+        delete node;
+    }
+
+    /**
+     * @brief Parallel search driven by #WorkStealingScheduler: every thread expands nodes from its own deque (merge child
+     * on top, so each thread dives depth-first) and idle threads steal the shallowest open nodes of the others.
+     * Each thread draws nodes from its own pool; a stolen node is recycled into the pool of the thread that expanded it.
+     */
+    void branchAndBoundWorkStealing(const Node& root) {
+        try {
+            int numThreads = omp_in_parallel() ? 1 : omp_get_max_threads();
+            WorkStealingScheduler<Node> scheduler(numThreads);
+            std::vector<NodePool<Node> > pools;
+            for(int i = 0; i < numThreads; i++)
+                pools.emplace_back(i == 0 ? root.numActiveVertices + 2 : 0, root);
+
+            scheduler.run(copyNode(pools[0], root), [&](int thread, Node* node) {
+                if(node->numActiveVertices <= 1 || searchFinished()) {
+                    pools[thread].release(node);
+                    return;
+                }
+
+                auto vertices = evaluateNode(*node);
+                if(vertices.first == -1 || vertices.second == -1) {
+                    pools[thread].release(node);
+                    return;
+                }
+
+                Node* edgeNode = copyNode(pools[thread], *node);
+                addEdgeInPlace(*edgeNode, vertices.first, vertices.second);
+                scheduler.push(thread, edgeNode);
+
+                mergeVerticesInPlace(*node, vertices.first, vertices.second);
+                scheduler.push(thread, node);
+            });
+            if(debugOut) {
+                std::cout << "Work stealing: " << scheduler.getNumThreads() << " threads, " << scheduler.getNumSteals()
+                    << " steals" << std::endl;
+            }
+        } catch(const std::exception& e) {
+            std::cout << "Error in branchAndBoundWorkStealing: " << e.what() << std::endl;
+        }
     }
 
 private:
-    int globalLowerBound;
-    int globalUpperBound;
-    int debugOut = 1;
+    static const long deadlineCheckInterval = 256;     // evaluated nodes between two reads of the clock
+
+    SolverOptions options;
+    std::atomic<int> globalLowerBound;
+    std::atomic<int> globalUpperBound;
+    SpinLock bestColoringLock;      // guards bestColoring; taken only when the upper bound improves
+    int debugOut;
+    std::atomic<bool> stopRequested;
+    std::atomic<long> numNodes;     // number of evaluated nodes
+    long pollInterval;
+    std::function<void()> pollCallback;
+    ProgressTrace::Source trace;
+    SpinLock threadPoolsLock;
+    std::unordered_map<std::thread::id, std::unique_ptr<NodePool<Node> > > threadPools;
+
+    /**
+     * @brief The node pool of the calling thread. Pools live as long as the solver, so their nodes keep their buffers
+     * from one search (or task subtree) to the next; looked up once per search call, not per node.
+     */
+    NodePool<Node>& threadPool() {
+        std::lock_guard<SpinLock> lock(threadPoolsLock);
+        std::unique_ptr<NodePool<Node> >& pool = threadPools[std::this_thread::get_id()];
+        if(!pool) pool.reset(new NodePool<Node>());
+        return *pool;
+    }
 
-    int greedyColoring(std::vector<int>);
+    /**
+     * @brief A copy of #node drawn from #pool; the copies are timed as one phase of the search statistics
+     */
+    static Node* copyNode(NodePool<Node>& pool, const Node& node) {
+        SearchStats::ScopedTimer timer(SearchStats::phase_copy);
+        return pool.acquire(node);
+    }
+
+    void raiseLowerBound(int lowerBound) {
+        int current = globalLowerBound.load();
+        while(lowerBound > current) {
+            if(globalLowerBound.compare_exchange_weak(current, lowerBound)) {
+                traceProgress(ProgressTrace::event_bound);
+                return;
+            }
+        }
+    }
+
+    bool searchFinished() const {
+        return globalLowerBound >= globalUpperBound || stopRequested.load(std::memory_order_relaxed);
+    }
+
+    int greedyColoring(const Node& node, std::vector<int>& colors);
     std::vector<int> findMaxClique();
     void branchAndBound(std::vector<int> &currentColoring, int maxColor);
     int chooseVertex(std::vector<int> &currentColoring);
@@ -224,26 +697,72 @@ private:
 };
 
 template <class VectorT>
-VertexColoring<VectorT>::VertexColoring(Graph<VectorT>& g) : graph(g) {}
-
+VertexColoring<VectorT>::VertexColoring(Graph<VectorT>& g, const SolverOptions& options) : 
+    graph(g), options(options), globalLowerBound(0), globalUpperBound(g.getNumVertices()), debugOut(options.debugOutput),
+    stopRequested(false), numNodes(0), pollInterval(1) {}
+
+/**
+ * @brief Compute the bounds of the root: a clique for the lower bound, a greedy coloring (stored in #bestColoring) 
+ * for the upper bound
+ * @param knownLowerBound   a lower bound known from elsewhere, see #findChromaticNumber
+ * @return true if the bounds already meet and no search is needed
+ */
 template <class VectorT>
-int VertexColoring<VectorT>::findChromaticNumber() {
-    // Initialize root node
+bool VertexColoring<VectorT>::initializeBounds(int knownLowerBound) {
     Node rootNode(graph);
-    
-    // Initialize bounds
     maxClique = graph.findMaxCliqueApprox();
-    globalLowerBound = maxClique.size();
+    globalLowerBound = std::max<int>(maxClique.size(), knownLowerBound);
     std::vector<int> initialColoring(graph.getNumVertices(), -1);
-    globalUpperBound = greedyColoring(initialColoring);
-    
-    if(globalLowerBound == globalUpperBound) {
-        return globalLowerBound;
+    globalUpperBound = greedyColoring(rootNode, initialColoring);
+    bestColoring = initialColoring;
+    return globalLowerBound >= globalUpperBound;
+}
+
+/**
+ * @brief Find the chromatic number of the graph and store the coloring in #bestColoring
+ * @param knownLowerBound   a lower bound known from elsewhere (e.g. from other components of the same graph); 
+ *                          the search stops as soon as a coloring with this many colors is found, so getLowerBound() 
+ *                          is then a bound for the whole graph rather than for this one
+ * @return the number of colors used by #bestColoring; if the search was stopped (see requestStop()), 
+ *         getLowerBound() may be below it
+ */
+template <class VectorT>
+int VertexColoring<VectorT>::findChromaticNumber(int knownLowerBound) {
+    bool solvedAtRoot = initializeBounds(knownLowerBound);
+    startTrace("zykov");
+    if(solvedAtRoot) {
+        traceProgress(ProgressTrace::event_end);
+        return globalUpperBound;
     }
+    Node rootNode(graph);
     
     // Start branch and bound
-    branchAndBoundSequential(rootNode);
+    if(options.searchMode == SolverOptions::search_recursive) {
+        branchAndBoundSequential(rootNode);
+    } else if(options.searchMode == SolverOptions::search_stealing) {
+        branchAndBoundWorkStealing(rootNode);
+    } else if(options.searchMode == SolverOptions::search_tasks) {
+        // when already inside a parallel region (e.g. one task per component), the tasks join the enclosing team
+        if(omp_in_parallel()) {
+            #pragma omp taskgroup
+            branchAndBoundParallel(new Node(rootNode));
+        } else {
+            #pragma omp parallel
+            #pragma omp single
+            #pragma omp taskgroup
+            branchAndBoundParallel(new Node(rootNode));
+        }
+    } else if(options.nodeOrder != SolverOptions::order_dfs) {
+        branchAndBoundBestFirst(rootNode);
+    } else {
+        branchAndBoundIterative(rootNode);
+    }
     
+    // the search either explored the whole tree or reached the lower bound, so the best coloring is optimal
+    if(!stopRequested) {
+        globalLowerBound = globalUpperBound.load();
+    }
+    traceProgress(ProgressTrace::event_end);
     return globalUpperBound;
 }
 
@@ -276,59 +795,43 @@ int VertexColoring<VectorT>::countDistinctNeighborColors(int vertex, const std::
     return uniqueColors.size();
 }
 
+/**
+ * @brief Greedily color the contracted graph of #node (its active vertices, in index order, see
+ * Graph::greedyColoring), keeping the colors already set in #colors; merged-away vertices then get the color of the
+ * vertex they were merged into
+ * @param node      the node to color
+ * @param colors    input: preset colors (or -1) of active vertices; output: a proper coloring of the input graph
+ * @return the number of colors used
+ */
 template <class VectorT>
-int VertexColoring<VectorT>::greedyColoring(std::vector<int> inputColors) {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    std::vector<int> colors = inputColors;
-    int numVertices = graph.getNumVertices();
-    std::vector<bool> availableColors(numVertices, true);
-    int maxUsedColor = 0;
+int VertexColoring<VectorT>::greedyColoring(const Node& node, std::vector<int>& colors) {
+    SearchStats::ScopedTimer timer(SearchStats::phase_coloring);
 
+    int numVertices = node.graph.getNumVertices();
+    int numColors = node.graph.greedyColoring(node.isActive, colors);
     for (int v = 0; v < numVertices; ++v) {
-        if (colors[v] == -1){
-            for (int i = 0; i < numVertices; ++i) {
-                if (graph.areNeighbours(v, i) && colors[i] != -1) {
-                    availableColors[colors[i]] = false;
-                }
-            }
-
-            int color;
-            for (color = 0; color < numVertices; ++color) {
-                if (availableColors[color]) break;
-            }
-            colors[v] = color;
-        }
-        maxUsedColor = std::max(maxUsedColor, colors[v]);
-        std::fill(availableColors.begin(), availableColors.end(), true);
+        if (!node.isActive[v])
+            colors[v] = colors[node.representative(v)];
     }
     isProperlyColored(colors);
-    bestColoring = colors;
-    auto stop = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-    //std::cout << "Upper bound duration: " << duration.count() << "ms\n";
-    return maxUsedColor+1;
+    return numColors;
 }
 
+/**
+ * @brief Check #coloring against the graph (see Graph::findColoringConflict) and report the first problem found
+ */
 template <class VectorT>
 bool VertexColoring<VectorT>::isProperlyColored(const std::vector<int>& coloring) {
-    
-    if (std::find(coloring.begin()+1, coloring.end(), -1) != coloring.end()) {
-        std::cout << "ERR: Found uncolored vertex \n";
-        return false;
+    std::pair<int, int> conflict = graph.findColoringConflict(coloring);
+    if (conflict.first == -1) {
+        return true;
     }
-    
-    // Check if adjacent vertices have different colors
-    for (int v = 0; v < coloring.size(); ++v) {
-        for (int u = v + 1; u < coloring.size(); ++u) {
-            if (graph.areNeighbours(v, u) && coloring[v] == coloring[u]) {
-                std::cout << "ERR: Vertices " << v << " and " << u << " are colored the same\n";
-                return false;
-            }
-        }
+    if (conflict.second == -1) {
+        std::cout << "ERR: Found uncolored vertex " << conflict.first << "\n";
+    } else {
+        std::cout << "ERR: Vertices " << conflict.first << " and " << conflict.second << " are colored the same\n";
     }
-    
-    return true;
+    return false;
 }
 
 #endif // VERTEX_COLORING_H
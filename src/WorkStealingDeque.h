@@ -0,0 +1,128 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Lock-free Chase-Lev work-stealing deque (with the C11 memory orderings of Lê et al., PPoPP 2013).
+ *
+ * The owner thread pushes and pops at the bottom (LIFO, keeps depth-first locality); any other thread steals from
+ * the top, i.e. it takes the oldest item. The circular buffer grows when full; replaced buffers are kept until the
+ * deque is destroyed, because a concurrent thief may still be reading from them.
+ *
+ * @tparam T item type; must be trivially copyable (typically a pointer)
+ */
+template<class T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(long initialCapacity = 64) : top(0), bottom(0) {
+        long capacity = 1;
+        while (capacity < initialCapacity) capacity *= 2;
+        array.store(new Array(capacity), std::memory_order_relaxed);
+    }
+
+    ~WorkStealingDeque() {
+        delete array.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < retired.size(); ++i)
+            delete retired[i];
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator= (const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief Push an item at the bottom; owner thread only
+     */
+    void push(T item) {
+        long b = bottom.load(std::memory_order_relaxed);
+        long t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1)
+            a = grow(a, t, b);
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Pop the most recently pushed item; owner thread only
+     * @return false if the deque is empty (or the last item was just stolen)
+     */
+    bool pop(T& item) {
+        long b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = a->get(b);
+        if (t == b) {
+            // last item: race against thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item; may be called by any thread
+     * @return false if the deque is empty or another thread won the race for the item
+     */
+    bool steal(T& item) {
+        long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+        Array* a = array.load(std::memory_order_acquire);
+        item = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Approximate number of items (exact when called by the owner with no concurrent thieves)
+     */
+    long size() const {
+        long b = bottom.load(std::memory_order_relaxed);
+        long t = top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+private:
+    struct Array {
+        long capacity;
+        long mask;
+        std::atomic<T>* items;
+
+        explicit Array(long c) : capacity(c), mask(c - 1), items(new std::atomic<T>[c]) {}
+        ~Array() { delete[] items; }
+
+        T get(long i) const { return items[i & mask].load(std::memory_order_relaxed); }
+        void put(long i, T item) { items[i & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    // top is written by thieves, bottom only by the owner: keep them on separate cache lines
+    std::atomic<long> top;
+    char paddingTop[64 - sizeof(std::atomic<long>)];
+    std::atomic<long> bottom;
+    char paddingBottom[64 - sizeof(std::atomic<long>)];
+    std::atomic<Array*> array;
+    std::vector<Array*> retired;
+
+    Array* grow(Array* a, long t, long b) {
+        Array* bigger = new Array(a->capacity * 2);
+        for (long i = t; i < b; ++i)
+            bigger->put(i, a->get(i));
+        retired.push_back(a);
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+#endif // WORK_STEALING_DEQUE_H
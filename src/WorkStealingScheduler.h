@@ -0,0 +1,117 @@
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "WorkStealingDeque.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Runs a tree search over nodes of type T with one work-stealing deque per thread.
+ *
+ * Every thread expands nodes from the bottom of its own deque and pushes the children there, so it explores its
+ * part of the tree depth-first. A thread whose deque is empty steals the oldest (shallowest, hence largest) node of
+ * a randomly chosen victim, backing off exponentially while all deques are empty. The search ends when no node is 
+ * left anywhere: a node is counted from its push until its expansion has finished, and children are pushed before 
+ * their parent is finished, so the count cannot reach zero early.
+ *
+ * Threads are those of an OpenMP parallel region; inside an existing parallel region (where nested parallelism is
+ * off) the scheduler runs with a single thread.
+ */
+template<class T>
+class WorkStealingScheduler {
+public:
+    explicit WorkStealingScheduler(int numThreads) : numThreads(numThreads < 1 ? 1 : numThreads), pending(0), numSteals(0) {
+        for (int i = 0; i < this->numThreads; ++i)
+            deques.emplace_back(new WorkStealingDeque<T*>());
+    }
+
+    int getNumThreads() const { return numThreads; }
+
+    /**
+     * @brief Add a node to the deque of #thread; to be called from within the expand function of that thread
+     */
+    void push(int thread, T* node) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        deques[thread]->push(node);
+    }
+
+    /**
+     * @brief Search the tree rooted at #root
+     * @param root      the root node
+     * @param expand    called as expand(thread, node) for every node; it disposes of the node and push()es its children
+     */
+    template<class Expand>
+    void run(T* root, Expand expand) {
+        push(0, root);
+        #pragma omp parallel num_threads(numThreads)
+        {
+            int thread = 0;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            if (thread < numThreads)
+                workerLoop(thread, expand);
+        }
+    }
+
+    /**
+     * @brief Number of successful steals in the last run
+     */
+    long getNumSteals() const { return numSteals.load(); }
+
+private:
+    int numThreads;
+    std::vector<std::unique_ptr<WorkStealingDeque<T*> > > deques;
+    std::atomic<long> pending;          // nodes pushed whose expansion has not finished yet
+    std::atomic<long> numSteals;
+
+    template<class Expand>
+    void workerLoop(int thread, Expand& expand) {
+        uint64_t random = 0x9E3779B97F4A7C15ull * (thread + 1);
+        unsigned int backoff = 1;
+        const unsigned int maxBackoff = 1 << 10;
+        T* node;
+        while (true) {
+            if (deques[thread]->pop(node) || trySteal(thread, random, node)) {
+                backoff = 1;
+                expand(thread, node);
+                pending.fetch_sub(1, std::memory_order_acq_rel);
+                continue;
+            }
+            if (pending.load(std::memory_order_acquire) == 0)
+                break;
+            // idle: spin a little longer every time, then give the core away
+            if (backoff < maxBackoff) {
+                for (unsigned int i = 0; i < backoff; ++i)
+                    __builtin_ia32_pause();
+                backoff *= 2;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool trySteal(int thread, uint64_t& random, T*& node) {
+        if (numThreads == 1) return false;
+        for (int attempt = 0; attempt < numThreads; ++attempt) {
+            // xorshift64 victim selection
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            int victim = random % numThreads;
+            if (victim != thread && deques[victim]->steal(node)) {
+                numSteals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // WORK_STEALING_SCHEDULER_H
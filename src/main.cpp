@@ -6,9 +6,18 @@
 #include "Dimacs.h"
 #include "Graph.h"
 #include "VectorSet.h"
+#include "GraphReduction.h"
+#include "ComponentDecomposition.h"
+#include "SolverOptions.h"
+#include "SearchStats.h"
+#include "ProgressTrace.h"
 #include <VertexColoring.h>
 #include <omp.h>
 #include <chrono>
+#include <sys/resource.h>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 /**
  * @brief Calculate graph density from the number of vertices @link #v and number of edges @link e
  * @param v number of vertices
@@ -33,7 +42,7 @@ Graph<NodeSet> loadGraph(const char* fname) {
     
     DimacsLoader loader{};
     if (loader.load(fname) && (loader.getNumVertices() > 0)) {
-        graph.init(loader.getAdjacencyMatrix(), loader.getDegrees());
+        graph.init(loader.getAdjacencyMatrix());
         std::cout << "  this is a Dimacs file with a graph of " << loader.getNumVertices() << " vertices, " << loader.getNumEdges() << " edges, " 
             << getDensity(loader.getNumVertices(), loader.getNumEdges()) << " density" << std::endl;
         graph.wasRemapedTo0based = loader.verticesAreMappedFrom1based();
@@ -48,7 +57,7 @@ Graph<NodeSet> loadGraph(const char* fname) {
         typedef VectorSet<VertexId> NodeSet;
 
 
-int main(int argc, char** argv) {
+int run(int argc, char** argv) {
     try {
         // load commandline arguments (also generate graphs or load them from file, as required)
         using namespace CommandlineParameters;
@@ -61,7 +70,17 @@ int main(int argc, char** argv) {
         std::vector<int> bindProcessors;
         int numThreads = 0, numJobs = 1;
         bool invertInputGraph = false;
-        bool debugBnB = true;  // New parameter for debugging Branch and Bound
+        bool debugBnB = false;  // New parameter for debugging Branch and Bound
+        bool printStats = false;
+        std::string searchMode;
+        std::string engine = "zykov";
+        std::string nodeOrder = "dfs";
+        std::string branchingRule = "degree";
+        std::string simd = "auto";
+        std::string traceFile;
+        double traceInterval = 0.1;
+        SolverOptions solverOptions;
+        long maxOpenNodes = solverOptions.maxOpenNodes;
         Graph<NodeSet> inputGraph;
 
         std::cout << "Branch and Bound Algorithm for Graph Coloring\n";
@@ -75,6 +94,50 @@ int main(int argc, char** argv) {
             .setNumberOfValues(0)
             .bindToVariable(debugBnB);
 
+        parameterSet.addDefinition("-search", "Branch and bound traversal: recursive, iterative (explicit stack of pooled nodes), tasks (OpenMP tasks; default when more than one thread is available) or stealing (work-stealing deque per thread)")
+            .setNumberOfValues(1)
+            .bindToVariable(searchMode);
+
+        parameterSet.addDefinition("-engine", "Exact coloring algorithm: zykov (merge / add-edge branching, default) dsatur (DSATUR branch and bound, sequential per component) cdcl (k-colorability with nogood learning for decreasing k, sequential per component) or portfolio (all three concurrently, sharing bounds; zykov gets all threads but two)")
+            .setNumberOfValues(1)
+            .bindToVariable(engine);
+
+        parameterSet.addDefinition("-branching", "Zykov branching pair: degree (largest degree sum, default) or common (most common neighbours)")
+            .setNumberOfValues(1)
+            .bindToVariable(branchingRule);
+
+        parameterSet.addDefinition("-order", "Node order of -search iterative: dfs (default), best (smallest lower bound first) or hybrid (best-first, depth-first dives while more than -max-open-nodes nodes are open)")
+            .setNumberOfValues(1)
+            .bindToVariable(nodeOrder);
+
+        parameterSet.addDefinition("-max-open-nodes", "With -order hybrid, the number of open nodes above which the search dives depth-first")
+            .setNumberOfValues(1)
+            .bindToVariable(maxOpenNodes);
+
+        parameterSet.addDefinition("-timeout", "Wall-clock limit in seconds (default 1000, 0: no limit); when it passes, the search stops and the best coloring found is reported with its bounds")
+            .setNumberOfValues(1)
+            .bindToVariable(timeout);
+
+        parameterSet.addDefinition("-task-depth", "With -search tasks, the depth of the search tree below which no more tasks are spawned")
+            .setNumberOfValues(1)
+            .bindToVariable(solverOptions.taskCutoffDepth);
+
+        parameterSet.addDefinition("-stats", "Count search nodes, prunings, merges and added edges, time the clique and coloring bounds, the branching choice and node copies, and print a summary at the end")
+            .setNumberOfValues(0)
+            .bindToVariable(printStats);
+
+        parameterSet.addDefinition("-trace", "Write the bounds of every search over time to a CSV file: a record at the start, on every bound change, at the end and every -trace-interval seconds in between (with MPI, rank r > 0 writes to FILE.r)")
+            .setNumberOfValues(1)
+            .bindToVariable(traceFile);
+
+        parameterSet.addDefinition("-trace-interval", "Seconds between two periodic records of -trace (default 0.1)")
+            .setNumberOfValues(1)
+            .bindToVariable(traceInterval);
+
+        parameterSet.addDefinition("-simd", "Bit set kernels: auto (default, the fastest this CPU runs, from CPUID), avx512, avx2 or scalar")
+            .setNumberOfValues(1)
+            .bindToVariable(simd);
+
         // TODO add all missing definitions
                 
         // parse the parameters
@@ -96,6 +159,42 @@ int main(int argc, char** argv) {
             throw;
         }
         
+        if (searchMode.empty())
+            searchMode = (omp_get_max_threads() > 1 ? "tasks" : "iterative");
+        if (!solverOptions.setSearchMode(searchMode)) {
+            std::cout << "Error: unknown search mode " << searchMode << std::endl;
+            return 0;
+        }
+        if (!solverOptions.setEngine(engine)) {
+            std::cout << "Error: unknown engine " << engine << std::endl;
+            return 0;
+        }
+        if (!solverOptions.setNodeOrder(nodeOrder)) {
+            std::cout << "Error: unknown node order " << nodeOrder << std::endl;
+            return 0;
+        }
+        solverOptions.maxOpenNodes = maxOpenNodes;
+        if (!solverOptions.setBranchingRule(branchingRule)) {
+            std::cout << "Error: unknown branching rule " << branchingRule << std::endl;
+            return 0;
+        }
+        solverOptions.debugOutput = debugBnB;
+        SearchStats::enable(printStats);
+        if (!BitSetKernels::select(simd)) {
+            std::cout << "Error: unknown bit set kernels " << simd << " or not supported by this CPU" << std::endl;
+            return 0;
+        }
+        if (debugBnB)
+            std::cout << "Bit set kernels: " << BitSetKernels::active().name << std::endl;
+        solverOptions.setTimeLimit(timeout);
+#ifdef USE_MPI
+        int numRanks = 1;
+        MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+        solverOptions.distributed = (numRanks > 1);
+        if (solverOptions.distributed)
+            std::cout << "Distributed search over " << numRanks << " MPI ranks\n";
+#endif
+
         if (inputGraphParameters.size() == 1){ 
             try {        
                 const char* testCliqueFile = (inputGraphParameters[0].c_str() == nullptr ? "12345.clq" : inputGraphParameters[0].c_str());
@@ -122,18 +221,42 @@ int main(int argc, char** argv) {
                 //     inputGraph.debugAdjacencyOut();
                 // }
 
-                // Create and run the vertex coloring algorithm
-                VertexColoring<NodeSet> coloring(inputGraph);
-                
                 // Get initial bounds
                 auto initialClique = inputGraph.findMaxCliqueApprox();
-                std::cout << "\nInitial lower bound (max clique size): " << initialClique.size() << std::endl;
+                int lowerBound = initialClique.size();
+                std::cout << "\nInitial lower bound (max clique size): " << lowerBound << std::endl;
                 
                 // Start timing
                 auto start = std::chrono::high_resolution_clock::now();
+                ProgressTrace::Source wholeGraph;
+                if (!traceFile.empty()) {
+#ifdef USE_MPI
+                    int rank = 0;
+                    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+                    if (rank > 0)
+                        traceFile += "." + std::to_string(rank);
+#endif
+                    if (!ProgressTrace::open(traceFile, traceInterval))
+                        throw std::runtime_error("Unable to write the trace file " + traceFile);
+                    wholeGraph.start("input graph", inputGraph.getNumVertices());
+                    wholeGraph.record(ProgressTrace::event_start, 0, lowerBound, inputGraph.getNumVertices());
+                }
                 
-                // Run the branch and bound algorithm
-                int chromaticNumber = coloring.findChromaticNumber();
+                // Shrink the graph before the search; removed vertices are colored afterwards
+                GraphReduction<NodeSet> reduction(inputGraph);
+                Graph<NodeSet> reducedGraph = reduction.reduce(lowerBound);
+                std::cout << "Reduced graph: " << reducedGraph.getNumVertices() << " vertices, " << reducedGraph.getNumEdges() << " edges ("
+                    << reduction.getNumRemoved() << " vertices removed, " << reduction.getNumDominated() << " of them dominated)" << std::endl;
+
+                // Run the vertex coloring algorithm on each connected component of the reduced graph
+                ComponentDecomposition<NodeSet> components(reducedGraph, solverOptions);
+                int chromaticNumber = std::max(lowerBound, components.solve(lowerBound));
+                int provenLowerBound = std::max(lowerBound, components.getLowerBound());
+                std::cout << "Connected components: " << components.getNumComponents() << " (" 
+                    << components.getNumSkipped() << " colored within the bound without search)" << std::endl;
+                std::vector<int> finalColoring = reduction.extendColoring(components.getColoring());
+                wholeGraph.record(ProgressTrace::event_end, components.getNumNodes(), provenLowerBound, chromaticNumber);
+                ProgressTrace::close();
                 
                 // End timing
                 auto end = std::chrono::high_resolution_clock::now();
@@ -141,17 +264,37 @@ int main(int argc, char** argv) {
 
                 // Output results
                 std::cout << "\nResults:" << std::endl;
-                std::cout << "Chromatic number: " << chromaticNumber << std::endl;
+                if (provenLowerBound >= chromaticNumber) {
+                    std::cout << "Chromatic number: " << chromaticNumber << std::endl;
+                } else {
+                    std::cout << "Time limit of " << timeout << " s reached, the search is incomplete" << std::endl;
+                    std::cout << "Best coloring found: " << chromaticNumber << " colors" << std::endl;
+                    std::cout << "Lower bound: " << provenLowerBound << std::endl;
+                    std::cout << "Gap: " << chromaticNumber - provenLowerBound << std::endl;
+                }
                 std::cout << "Computation time: " << duration.count() << " ms" << std::endl;
+                struct rusage usage;
+                getrusage(RUSAGE_SELF, &usage);
+                std::cout << "Nodes explored: " << components.getNumNodes() << std::endl;
+                std::cout << "Peak memory: " << usage.ru_maxrss / 1024 << " MB" << std::endl;
                 
                 // Verify the solution
-                bool check = coloring.isProperlyColored(coloring.bestColoring);
+                VertexColoring<NodeSet> verification(inputGraph);
+                bool check = verification.isProperlyColored(finalColoring);
                 std::cout << "Solution verification: " << (check ? "VALID" : "INVALID") << std::endl;
+                if (printStats)
+                    SearchStats::print(std::cout);
+
+                if (provenLowerBound < chromaticNumber && !debugBnB) {
+                    std::cout << "\nBest coloring (color of each vertex):" << std::endl;
+                    for (size_t i = 0; i < finalColoring.size(); i++)
+                        std::cout << finalColoring[i] << (i + 1 < finalColoring.size() ? " " : "\n");
+                }
 
                 if (debugBnB) {
                     std::cout << "\nFinal coloring:" << std::endl;
-                    for (size_t i = 0; i < coloring.bestColoring.size(); i++) {
-                        std::cout << "Vertex " << i << ": Color " << coloring.bestColoring[i] << std::endl;
+                    for (size_t i = 0; i < finalColoring.size(); i++) {
+                        std::cout << "Vertex " << i << ": Color " << finalColoring[i] << std::endl;
                     }
                 }
 
@@ -177,3 +320,20 @@ int main(int argc, char** argv) {
     }
     return 0;
 }
+
+int main(int argc, char** argv) {
+#ifdef USE_MPI
+    // only the main thread makes MPI calls
+    int provided, rank;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    // all ranks run the whole pipeline, but only rank 0 reports
+    if (rank != 0)
+        std::cout.setstate(std::ios_base::badbit);
+#endif
+    int result = run(argc, argv);
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
+    return result;
+}
@@ -0,0 +1,361 @@
+// Microbenchmarks of the Graph and VectorSet primitives the search spends its time in, on random graphs of several
+// sizes and densities. Each primitive is called in a loop long enough to time (a sample), after warmup samples; the
+// table gives min / median / mean per call and the relative standard deviation over the samples.
+//
+// The output has one line per primitive, size and density, always in the same order, so the tables of two commits can
+// be diffed; -baseline FILE reads an earlier table and adds the ratio of the medians. The column "result" is what the
+// first call returned and should not change unless the primitive computes something else.
+// Runs single-threaded and pinned to one CPU (-cpu -1 leaves the scheduler free). Build and run with `make microbench`
+// from src/, or from this directory:
+//     g++ -std=c++11 -O3 -march=x86-64-v2 -fopenmp MicroBenchmark.cpp -I ../src -o microbench && ./microbench
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "../src/BitSetKernels.h"
+#include "../src/Graph.h"
+#include "../src/VectorSet.h"
+#include "../src/VertexColoring.h"
+
+typedef int VertexId;
+typedef VectorSet<VertexId> NodeSet;
+typedef VertexColoring<NodeSet> Solver;
+
+struct Options {
+    std::vector<int> sizes;
+    std::vector<double> densities;
+    int samples;
+    int warmup;
+    double minSampleMs;
+    int cpu;
+    std::string only;
+    std::string baseline;
+    Options() : sizes({64, 256, 1024}), densities({0.1, 0.5, 0.9}), samples(15), warmup(3), minSampleMs(1), cpu(-2) {}
+};
+
+struct Summary {
+    double min, median, mean, relStddev;
+};
+
+/**
+ * @brief One primitive on one graph; #op does one call and returns something of its result, which is summed into a
+ * volatile sink so that the calls cannot be optimized away
+ */
+struct Benchmark {
+    std::string name;
+    int n;
+    double density;
+    std::function<long()> op;
+};
+
+static volatile long sink;
+
+/**
+ * @brief Time #samples samples of #b after #warmup, each of as many calls as take at least #minSampleMs
+ * @return per call times in ns
+ */
+static Summary run(const Benchmark& b, const Options& options, long& firstResult) {
+    typedef std::chrono::steady_clock Clock;
+    firstResult = b.op();
+    long iterations = 1;
+    double nanos = 0;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        long s = 0;
+        for (long i = 0; i < iterations; ++i) s += b.op();
+        sink += s;
+        nanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (nanos >= options.minSampleMs * 1e6 || iterations >= (1L << 30)) break;
+        // aim a bit past the minimum, so that the samples do not end up just below it
+        iterations = nanos > 0 ? std::max(iterations * 2, (long)(iterations * options.minSampleMs * 1.2e6 / nanos)) : iterations * 2;
+    }
+
+    std::vector<double> times;
+    for (int sample = 0; sample < options.warmup + options.samples; ++sample) {
+        Clock::time_point start = Clock::now();
+        long s = 0;
+        for (long i = 0; i < iterations; ++i) s += b.op();
+        sink += s;
+        double t = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+        if (sample >= options.warmup) times.push_back(t);
+    }
+
+    Summary summary;
+    std::sort(times.begin(), times.end());
+    size_t k = times.size();
+    summary.min = times[0];
+    summary.median = k % 2 ? times[k / 2] : (times[k / 2 - 1] + times[k / 2]) / 2;
+    double sum = 0, squares = 0;
+    for (size_t i = 0; i < k; ++i) sum += times[i];
+    summary.mean = sum / k;
+    for (size_t i = 0; i < k; ++i) squares += (times[i] - summary.mean) * (times[i] - summary.mean);
+    summary.relStddev = k > 1 ? 100 * std::sqrt(squares / (k - 1)) / summary.mean : 0;
+    return summary;
+}
+
+/**
+ * @brief G(n, p) with a seed derived from n and p only, so every run and every commit benchmarks the same graphs
+ */
+static Graph<NodeSet> randomGraph(int n, double density) {
+    std::mt19937_64 rng(n * 1000003ULL + (unsigned long long)(density * 1000));
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<std::vector<char> > adjacency(n, std::vector<char>(n, 0));
+    for (int i = 0; i < n; ++i)
+        for (int j = i + 1; j < n; ++j)
+            if (uniform(rng) < density)
+                adjacency[i][j] = adjacency[j][i] = 1;
+    Graph<NodeSet> g;
+    g.init(adjacency);
+    return g;
+}
+
+/**
+ * @brief The benchmarks of one graph; the state they work on is owned by their closures
+ */
+static void addBenchmarks(std::vector<Benchmark>& benchmarks, int n, double density, const SolverOptions& solverOptions) {
+    std::shared_ptr<Graph<NodeSet> > g = std::make_shared<Graph<NodeSet> >(randomGraph(n, density));
+    std::mt19937_64 rng(n + 17);
+
+    // a candidate set of about half the vertices, as in a clique search, and its intersections with some rows
+    std::shared_ptr<NodeSet> candidates = std::make_shared<NodeSet>();
+    for (int v = 0; v < n; ++v)
+        if (rng() % 2) candidates->push_back(v);
+    std::shared_ptr<std::vector<NodeSet> > subsets = std::make_shared<std::vector<NodeSet> >(16);
+    for (size_t i = 0; i < subsets->size(); ++i)
+        intersectWithAdjecency(*candidates, g->adjacencyMatrix[(i * 7919) % n], (*subsets)[i]);
+    std::shared_ptr<NodeSet> result = std::make_shared<NodeSet>();
+
+    // each benchmark steps through the vertices (or subsets) with its own counter, so its first call is always the same
+    std::shared_ptr<int> next = std::make_shared<int>(0);
+    benchmarks.push_back({"intersectWithAdjecency", n, density, [=]() {
+        int v = (*next = (*next + 1) % n);
+        result->clear();
+        intersectWithAdjecency(*candidates, g->adjacencyMatrix[v], *result);
+        return (long)result->size();
+    }});
+    next = std::make_shared<int>(0);
+    benchmarks.push_back({"VectorSet::contains", n, density, [=]() {
+        int v = (*next = (*next + 1) % n);
+        return (long)candidates->contains(v);
+    }});
+    next = std::make_shared<int>(0);
+    benchmarks.push_back({"VectorSet::isIntersectionOf", n, density, [=]() {
+        *next = (*next + 1) % subsets->size();
+        return (long)(*subsets)[*next].isIntersectionOf(*candidates);
+    }});
+
+    std::shared_ptr<Graph<NodeSet>::CoreDecomposition> cores = std::make_shared<Graph<NodeSet>::CoreDecomposition>();
+    std::shared_ptr<std::vector<int> > bin = std::make_shared<std::vector<int> >(), pos = std::make_shared<std::vector<int> >();
+    benchmarks.push_back({"computeCoreDecomposition", n, density, [=]() {
+        g->computeCoreDecompositionSequential(*cores, *bin, *pos);
+        return (long)cores->degeneracy;
+    }});
+    std::shared_ptr<NodeSet> clique = std::make_shared<NodeSet>();
+    benchmarks.push_back({"findMaxCliqueApprox", n, density, [=]() {
+        g->findMaxCliqueApprox(*clique);
+        return (long)clique->size();
+    }});
+
+    // renumbering with the same permutation again and again keeps the graph isomorphic, so every call costs the same
+    std::shared_ptr<Graph<NodeSet> > renumbered = std::make_shared<Graph<NodeSet> >(*g);
+    std::shared_ptr<std::vector<int> > order = std::make_shared<std::vector<int> >(n);
+    for (int v = 0; v < n; ++v) (*order)[v] = v;
+    std::shuffle(order->begin(), order->end(), rng);
+    benchmarks.push_back({"orderVertices", n, density, [=]() {
+        renumbered->orderVertices(*order);
+        return (long)renumbered->degrees[0];
+    }});
+
+    BitSet all(n, true);
+    std::shared_ptr<std::vector<int> > colors = std::make_shared<std::vector<int> >(n);
+    benchmarks.push_back({"greedyColoring", n, density, [=]() {
+        std::fill(colors->begin(), colors->end(), -1);
+        return (long)g->greedyColoring(all, *colors);
+    }});
+    std::shared_ptr<std::vector<int> > coloring = std::make_shared<std::vector<int> >(n, -1);
+    g->greedyColoring(all, *coloring);
+    benchmarks.push_back({"findColoringConflict", n, density, [=]() {
+        return (long)g->findColoringConflict(*coloring).first;
+    }});
+
+    // a sequence of merges that is valid when replayed from the root: each pair is non-adjacent in the contracted graph
+    std::shared_ptr<Solver> solver = std::make_shared<Solver>(*g, solverOptions);
+    std::shared_ptr<Solver::Node> root = std::make_shared<Solver::Node>(*g), scratch = std::make_shared<Solver::Node>(*g);
+    std::shared_ptr<std::vector<std::pair<int, int> > > merges = std::make_shared<std::vector<std::pair<int, int> > >();
+    std::vector<int> active(order->begin(), order->end());
+    while ((int)merges->size() < n / 4 && active.size() > 1) {
+        int v1 = active.back();
+        std::vector<int>::iterator v2 = std::find_if(active.begin(), active.end() - 1,
+            [&](int u) { return !scratch->graph.areNeighbours(v1, u); });
+        active.pop_back();
+        if (v2 == active.end()) continue;
+        solver->mergeVerticesInPlace(*scratch, *v2, v1);
+        merges->push_back(std::make_pair(*v2, v1));
+    }
+    benchmarks.push_back({"Node copy", n, density, [=]() {
+        *scratch = *root;
+        return (long)scratch->numActiveVertices;
+    }});
+    if (!merges->empty()) {
+        // a call restores the root and replays all merges; subtract "Node copy" and divide by their number for one merge
+        benchmarks.push_back({"Node copy + mergeVertices x" + std::to_string(merges->size()), n, density, [=]() {
+            *scratch = *root;
+            for (size_t i = 0; i < merges->size(); ++i)
+                solver->mergeVerticesInPlace(*scratch, (*merges)[i].first, (*merges)[i].second);
+            return (long)scratch->numActiveVertices;
+        }});
+    }
+}
+
+static std::string key(const std::string& name, int n, double density) {
+    std::ostringstream s;
+    s << name << " " << n << " " << std::fixed << std::setprecision(2) << density;
+    return s.str();
+}
+
+/**
+ * @brief Medians of an earlier table, by primitive, size and density; the name may contain blanks, the numbers not
+ */
+static std::map<std::string, double> readBaseline(const std::string& fileName) {
+    std::map<std::string, double> medians;
+    std::ifstream in(fileName.c_str());
+    if (!in) throw std::runtime_error("Cannot read the baseline " + fileName);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<std::string> fields;
+        std::istringstream s(line);
+        for (std::string f; s >> f;) fields.push_back(f);
+        // name..., n, density, min, median, mean, sd%, result [, ratio]
+        bool hasRatio = !fields.empty() && (fields.back() == "-" || fields.back().find('x') != std::string::npos);
+        size_t numbers = hasRatio ? 8 : 7;
+        if (fields.size() < numbers + 1 || !std::isdigit(fields[fields.size() - numbers][0])) continue;
+        size_t first = fields.size() - numbers;
+        std::string name = fields[0];
+        for (size_t i = 1; i < first; ++i) name += " " + fields[i];
+        medians[key(name, std::atoi(fields[first].c_str()), std::atof(fields[first + 1].c_str()))] = std::atof(fields[first + 3].c_str());
+    }
+    return medians;
+}
+
+template<class T>
+static std::vector<T> parseList(const char* arg) {
+    std::vector<T> values;
+    std::istringstream s(arg);
+    for (std::string item; std::getline(s, item, ',');) {
+        std::istringstream v(item);
+        T value;
+        if (!(v >> value)) throw std::runtime_error(std::string("Invalid list ") + arg);
+        values.push_back(value);
+    }
+    return values;
+}
+
+static void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+        << "  -sizes 64,256,1024      numbers of vertices\n"
+        << "  -densities 0.1,0.5,0.9  edge probabilities\n"
+        << "  -samples 15             timed samples per benchmark\n"
+        << "  -warmup 3               untimed samples before them\n"
+        << "  -min-ms 1               minimum length of a sample\n"
+        << "  -cpu K                  pin to CPU K (default: the current one; -1: no pinning)\n"
+        << "  -only NAME              only the primitives whose name contains NAME\n"
+        << "  -baseline FILE          compare the medians with an earlier output\n"
+        << "  -simd NAME              bit set kernels (auto, scalar, avx2, avx512)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        Options options;
+        std::string simd = "auto";
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) { usage(argv[0]); return 1; }
+            const char* value = argv[++i];
+            if (arg == "-sizes") options.sizes = parseList<int>(value);
+            else if (arg == "-densities") options.densities = parseList<double>(value);
+            else if (arg == "-samples") options.samples = std::max(1, std::atoi(value));
+            else if (arg == "-warmup") options.warmup = std::max(0, std::atoi(value));
+            else if (arg == "-min-ms") options.minSampleMs = std::atof(value);
+            else if (arg == "-cpu") options.cpu = std::atoi(value);
+            else if (arg == "-only") options.only = value;
+            else if (arg == "-baseline") options.baseline = value;
+            else if (arg == "-simd") simd = value;
+            else { usage(argv[0]); return 1; }
+        }
+        if (!BitSetKernels::select(simd)) throw std::runtime_error("Unknown or unsupported bit set kernels " + simd);
+
+#ifdef _OPENMP
+        // the parallel variants of the primitives measure the machine more than the code
+        omp_set_num_threads(1);
+#endif
+        std::string pinning = "not pinned";
+#ifdef __linux__
+        if (options.cpu == -2) options.cpu = sched_getcpu();
+        if (options.cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(options.cpu, &set);
+            if (sched_setaffinity(0, sizeof(set), &set) != 0)
+                throw std::runtime_error("Cannot pin to CPU " + std::to_string(options.cpu));
+            pinning = "pinned to CPU " + std::to_string(options.cpu);
+        }
+#endif
+        std::map<std::string, double> baseline;
+        if (!options.baseline.empty()) baseline = readBaseline(options.baseline);
+
+        std::cout << "# " << BitSetKernels::active().name << " kernels, " << options.samples << " samples of >= "
+            << options.minSampleMs << " ms after " << options.warmup << " warmup samples, " << pinning << "; times in ns per call" << std::endl;
+        std::cout << std::left << std::setw(30) << "primitive" << std::right << std::setw(6) << "n" << std::setw(8) << "density"
+            << std::setw(13) << "min" << std::setw(13) << "median" << std::setw(13) << "mean" << std::setw(7) << "sd%"
+            << std::setw(8) << "result";
+        if (!options.baseline.empty()) std::cout << std::setw(9) << "vs base";
+        std::cout << std::endl;
+
+        SolverOptions solverOptions;
+        for (size_t i = 0; i < options.sizes.size(); ++i) {
+            for (size_t j = 0; j < options.densities.size(); ++j) {
+                std::vector<Benchmark> benchmarks;
+                addBenchmarks(benchmarks, options.sizes[i], options.densities[j], solverOptions);
+                for (size_t k = 0; k < benchmarks.size(); ++k) {
+                    const Benchmark& b = benchmarks[k];
+                    if (b.name.find(options.only) == std::string::npos) continue;
+                    long result = 0;
+                    Summary s = run(b, options, result);
+                    std::cout << std::left << std::setw(30) << b.name << std::right << std::setw(6) << b.n
+                        << std::fixed << std::setprecision(2) << std::setw(8) << b.density << std::setprecision(1)
+                        << std::setw(13) << s.min << std::setw(13) << s.median << std::setw(13) << s.mean
+                        << std::setw(7) << s.relStddev << std::setw(8) << result;
+                    if (!options.baseline.empty()) {
+                        std::map<std::string, double>::const_iterator base = baseline.find(key(b.name, b.n, b.density));
+                        if (base != baseline.end() && base->second > 0)
+                            std::cout << std::setw(8) << std::setprecision(2) << s.median / base->second << "x";
+                        else
+                            std::cout << std::setw(9) << "-";
+                    }
+                    std::cout << std::endl;
+                }
+            }
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error in microbench: " << e.what() << std::endl;
+        return 1;
+    }
+}
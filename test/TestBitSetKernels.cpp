@@ -0,0 +1,136 @@
+// Checks the scalar, AVX2 and AVX-512 word kernels of BitSet against a bit-by-bit reference, and the merge of two
+// vertices done with them against the matrix invariants. The kernel sets this CPU cannot run are skipped.
+// Build and run from this directory:
+//     g++ -std=c++11 -O2 -march=x86-64-v2 TestBitSetKernels.cpp -I ../src -o test_bitset_kernels && ./test_bitset_kernels
+#include <iostream>
+#include <vector>
+#include <random>
+#include "../src/BitSetKernels.h"
+#include "../src/BitSet.h"
+#include "../src/Graph.h"
+#include "../src/VectorSet.h"
+
+using namespace BitSetKernels;
+
+static int failures = 0;
+
+#define CHECK(cond, what) \
+    do { if (!(cond)) { std::cout << "FAILED: " << what << " (line " << __LINE__ << ")" << std::endl; failures++; } } while (0)
+
+static bool bit(const std::vector<Word>& a, size_t i) { return (a[i / 64] >> (i % 64)) & 1; }
+
+/**
+ * @brief Random words of one of three densities, so that the sparse and the empty cases of intersects() are covered
+ */
+static std::vector<Word> randomWords(std::mt19937_64& rng, size_t n, int density) {
+    std::vector<Word> a(n);
+    for (size_t i = 0; i < n; ++i) {
+        Word w = rng();
+        if (density == 0) w &= rng() & rng() & rng() & rng();
+        if (density == 1) w = (rng() % 16 == 0) ? ((Word)1 << (rng() % 64)) : 0;
+        a[i] = w;
+    }
+    return a;
+}
+
+static void testKernels(const KernelSet& k) {
+    std::mt19937_64 rng(42);
+    for (size_t n = 0; n <= 40; ++n) {
+        for (int round = 0; round < 20; ++round) {
+            std::vector<Word> a = randomWords(rng, n, round % 3), b = randomWords(rng, n, (round / 3) % 3);
+            // a guard word after the arrays catches stores past the end (masked tails)
+            a.push_back(0x5555555555555555ULL);
+            b.push_back(0xaaaaaaaaaaaaaaaaULL);
+
+            size_t count = 0, common = 0;
+            for (size_t i = 0; i < n * 64; ++i) {
+                count += bit(a, i);
+                common += bit(a, i) && bit(b, i);
+            }
+            CHECK(k.popcount(a.data(), n) == count, k.name << " popcount, " << n << " words");
+            CHECK(k.intersectionCount(a.data(), b.data(), n) == common, k.name << " intersectionCount, " << n << " words");
+            CHECK(k.intersects(a.data(), b.data(), n) == (common > 0), k.name << " intersects, " << n << " words");
+
+            std::vector<Word> r = a;
+            k.orInto(r.data(), b.data(), n);
+            for (size_t i = 0; i < n * 64; ++i)
+                if (bit(r, i) != (bit(a, i) || bit(b, i))) { CHECK(false, k.name << " orInto, " << n << " words"); break; }
+            CHECK(r[n] == a[n], k.name << " orInto wrote past the end");
+
+            r = a;
+            k.andInto(r.data(), b.data(), n);
+            for (size_t i = 0; i < n * 64; ++i)
+                if (bit(r, i) != (bit(a, i) && bit(b, i))) { CHECK(false, k.name << " andInto, " << n << " words"); break; }
+            CHECK(r[n] == a[n], k.name << " andInto wrote past the end");
+
+            r = a;
+            k.andNotInto(r.data(), b.data(), n);
+            for (size_t i = 0; i < n * 64; ++i)
+                if (bit(r, i) != (bit(a, i) && !bit(b, i))) { CHECK(false, k.name << " andNotInto, " << n << " words"); break; }
+            CHECK(r[n] == a[n], k.name << " andNotInto wrote past the end");
+        }
+    }
+}
+
+/**
+ * @brief Merge random non-adjacent pairs of a random graph and check symmetry, degrees and the complement matrix
+ */
+static void testMerge(size_t n) {
+    std::mt19937_64 rng(n);
+    std::vector<std::vector<char> > adjacency(n, std::vector<char>(n, 0));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = i + 1; j < n; ++j)
+            adjacency[i][j] = adjacency[j][i] = (rng() % 3 == 0);
+    Graph<VectorSet<int> > g;
+    g.init(adjacency);
+
+    std::vector<bool> merged(n, false);
+    for (int step = 0; step < (int)n / 2; ++step) {
+        int v1 = rng() % n, v2 = rng() % n;
+        if (v1 == v2 || merged[v1] || merged[v2] || g.areNeighbours(v1, v2)) continue;
+        BitSet expected = g.adjacencyMatrix[v1];
+        expected |= g.adjacencyMatrix[v2];
+        g.mergeNeighbourhoods(v1, v2);
+        merged[v2] = true;
+        CHECK(g.adjacencyMatrix[v1] == expected, "merge: row of v1 is not the union, n = " << n);
+        CHECK(g.adjacencyMatrix[v2].none(), "merge: v2 kept edges, n = " << n);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        CHECK((size_t)g.degrees[i] == g.adjacencyMatrix[i].count(), "merge: degree of " << i << ", n = " << n);
+        CHECK(!g.adjacencyMatrix[i][i] && !g.invAdjacencyMatrix[i][i], "merge: diagonal of " << i << ", n = " << n);
+        for (size_t j = 0; j < n; ++j) {
+            if (i == j) continue;
+            CHECK(g.adjacencyMatrix[i][j] == g.adjacencyMatrix[j][i], "merge: asymmetric " << i << "," << j);
+            CHECK(g.invAdjacencyMatrix[i][j] == !g.adjacencyMatrix[i][j], "merge: complement " << i << "," << j);
+        }
+    }
+}
+
+int main() {
+    const char* names[] = {"scalar", "avx2", "avx512"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        const KernelSet* k = find(names[i]);
+        if (!k) {
+            std::cout << "Skipping " << names[i] << ": not supported by this CPU" << std::endl;
+            continue;
+        }
+        std::cout << "Testing " << k->name << " kernels" << std::endl;
+        testKernels(*k);
+
+        // the merges go through BitSet, i.e. through the dispatching functions
+        CHECK(select(names[i]) && &active() == k, "select " << names[i]);
+        std::cout << "Testing merges with the " << active().name << " kernels" << std::endl;
+        size_t sizes[] = {5, 64, 130, 700};
+        for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); ++j)
+            testMerge(sizes[j]);
+    }
+    CHECK(!select("none"), "select of an unknown kernel set");
+    CHECK(select("auto") && &active() == &best(), "select auto");
+
+    if (failures) {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}
@@ -40,7 +40,7 @@ Graph<NodeSet> loadGraph(const char* fname) {
     
     DimacsLoader loader{};
     if (loader.load(fname) && (loader.getNumVertices() > 0)) {
-        graph.init(loader.getAdjacencyMatrix(), loader.getDegrees());
+        graph.init(loader.getAdjacencyMatrix());
         std::cout << "  this is a Dimacs file with a graph of " << loader.getNumVertices() << " vertices, " << loader.getNumEdges() << " edges, " 
             << getDensity(loader.getNumVertices(), loader.getNumEdges()) << " density" << std::endl;
 
@@ -0,0 +1,135 @@
+// Checks NodePool under interleavings of acquire, release, mark and releaseTo against a model of the nodes in use:
+// an acquired node must never be one that is still in use, releaseTo must give back exactly the nodes acquired since
+// its mark, and a search that marks and releases over and over must not grow the slab.
+// Build and run from this directory:
+//     g++ -std=c++11 -O2 TestNodePool.cpp -I ../src -o test_node_pool && ./test_node_pool
+#include <iostream>
+#include <vector>
+#include <set>
+#include <random>
+#include "../src/NodePool.h"
+
+static int failures = 0;
+
+#define CHECK(cond, what) \
+    do { if (!(cond)) { std::cout << "FAILED: " << what << " (line " << __LINE__ << ")" << std::endl; failures++; } } while (0)
+
+/**
+ * @brief A free node of the pool taken again while a mark is open, which used to leave a null pointer on the free list
+ */
+static void testReuseUnderMark() {
+    NodePool<int> pool;
+    int* a = pool.acquire(1);
+    pool.release(a);
+    NodePool<int>::Mark m = pool.mark();
+    int* b = pool.acquire(2);
+    pool.releaseTo(m);
+    int* c = pool.acquire(3);
+    int* d = pool.acquire(4);
+    CHECK(c && d && c != d, "two nodes after releaseTo");
+    CHECK(*c == 3 && *d == 4, "values of the nodes after releaseTo");
+    CHECK(b == c || b == d, "the node acquired under the mark is reused");
+    CHECK(pool.size() == 2, "slab size " << pool.size() << ", expected 2");
+    CHECK(pool.numInUse() == 2, "nodes in use " << pool.numInUse() << ", expected 2");
+}
+
+/**
+ * @brief Nested marks, released in last-in first-out order, with free nodes at each level
+ */
+static void testNestedMarks() {
+    NodePool<int> pool;
+    int* a = pool.acquire(1);
+    int* b = pool.acquire(2);
+    pool.release(a);
+    NodePool<int>::Mark outer = pool.mark();
+    int* c = pool.acquire(3);
+    pool.release(c);
+    NodePool<int>::Mark inner = pool.mark();
+    int* d = pool.acquire(4);
+    CHECK(d != a && d != b && d != c, "a node that is free at a mark is not reused under it");
+    pool.releaseTo(inner);
+    int* e = pool.acquire(5);
+    CHECK(e == c || e == d, "under the outer mark, its own free nodes are reused");
+    pool.releaseTo(outer);
+    CHECK(pool.numInUse() == 1, "nodes in use " << pool.numInUse() << ", expected 1");
+    int* f = pool.acquire(6);
+    int* g = pool.acquire(7);
+    CHECK(f != b && g != b && f != g, "distinct nodes after the outer releaseTo");
+    CHECK(*b == 2, "a node in use is not overwritten");
+}
+
+/**
+ * @brief Random interleavings; nodes acquired before a mark are only released outside of it, as the pool requires
+ */
+static void testRandom() {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 200; ++round) {
+        NodePool<int> pool;
+        std::set<int*> inUse;
+        // per open mark: the mark and the nodes acquired under it (and not released yet)
+        std::vector<std::pair<NodePool<int>::Mark, std::vector<int*> > > marks;
+        std::vector<int*> unmarked;     // acquired outside any mark
+        int value = 0;
+        for (int step = 0; step < 300; ++step) {
+            std::vector<int*>& own = marks.empty() ? unmarked : marks.back().second;
+            int op = rng() % 10;
+            if (op < 4) {
+                int* node = pool.acquire(++value);
+                CHECK(node != nullptr, "acquire returned null, round " << round);
+                CHECK(!inUse.count(node), "acquire returned a node in use, round " << round << " step " << step);
+                CHECK(*node == value, "acquire did not copy the source");
+                inUse.insert(node);
+                own.push_back(node);
+            } else if (op < 7 && !own.empty()) {
+                size_t i = rng() % own.size();
+                int* node = own[i];
+                own.erase(own.begin() + i);
+                inUse.erase(node);
+                pool.release(node);
+            } else if (op < 9 && marks.size() < 5) {
+                marks.push_back(std::make_pair(pool.mark(), std::vector<int*>()));
+            } else if (!marks.empty()) {
+                pool.releaseTo(marks.back().first);
+                for (size_t i = 0; i < marks.back().second.size(); ++i)
+                    inUse.erase(marks.back().second[i]);
+                marks.pop_back();
+            }
+            CHECK(pool.numInUse() == inUse.size(), "nodes in use " << pool.numInUse() << ", expected " << inUse.size());
+        }
+        for (std::set<int*>::const_iterator it = inUse.begin(); it != inUse.end(); ++it)
+            CHECK(**it > 0 && **it <= value, "a node in use holds " << **it);
+    }
+}
+
+/**
+ * @brief The pattern of the depth-first searches: mark, acquire a few nodes, release some, release to the mark
+ */
+static void testNoGrowth() {
+    NodePool<int> pool;
+    int* root = pool.acquire(0);
+    pool.release(pool.acquire(1));
+    for (int i = 0; i < 1000; ++i) {
+        NodePool<int>::Mark m = pool.mark();
+        int* a = pool.acquire(i);
+        pool.release(a);
+        pool.acquire(i);
+        pool.acquire(i);
+        pool.releaseTo(m);
+    }
+    CHECK(pool.size() <= 4, "slab grew to " << pool.size() << " nodes");
+    CHECK(pool.numInUse() == 1 && *root == 0, "only the root is in use");
+}
+
+int main() {
+    testReuseUnderMark();
+    testNestedMarks();
+    testRandom();
+    testNoGrowth();
+
+    if (failures) {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}